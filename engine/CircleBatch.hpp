@@ -0,0 +1,205 @@
+#pragma once
+
+#include <span>
+#include <bit>
+
+#include "common/Body.hpp"
+#include "../utils/simd.hpp"
+
+// what Collisions::intersectCircles finds, without the bodies
+struct CircleContact {
+    uint32_t pair;      // index into the candidate arrays
+    Vec2 normal;        // from first to second
+    float depth;
+};
+
+// circle-circle narrowphase over many candidate pairs at once, reading the store's columns.
+// pairs are rejected on squared distance; sqrt and division only run for batches with a hit.
+class CircleBatch {
+ private:
+    struct Input {
+        const float* x;
+        const float* y;
+        const float* radius;
+        const uint32_t* first;
+        const uint32_t* second;
+        float margin;       // pairs this far apart still count, with a negative depth
+    };
+
+    static void testScalar(const Input &in, uint32_t begin, uint32_t end, List<CircleContact> &out) {
+        for (uint32_t k = begin; k < end; ++k) {
+            const uint32_t a = in.first[k];
+            const uint32_t b = in.second[k];
+            const float dx = in.x[b] - in.x[a];
+            const float dy = in.y[b] - in.y[a];
+            const float radii = in.radius[a] + in.radius[b];
+            const float reach = radii + in.margin;
+            const float dist_sq = dx * dx + dy * dy;
+            if (dist_sq >= reach * reach)
+                continue;
+
+            const float dist = std::sqrt(dist_sq);
+            const float length = dist == 0.f ? 1.f : dist;
+            out.push_back({k, {dx / length, dy / length}, radii - dist});
+        }
+    }
+
+    // appends the lanes set in mask, in lane order so the output stays in pair order
+    static void emit(uint32_t base, uint32_t mask, const float* nx, const float* ny, const float* depth,
+                     List<CircleContact> &out) {
+        while (mask) {
+            const uint32_t lane = std::countr_zero(mask);
+            mask &= mask - 1;
+            out.push_back({base + lane, {nx[lane], ny[lane]}, depth[lane]});
+        }
+    }
+
+#if defined(PARTICLES_SIMD_X86)
+    PARTICLES_TARGET("avx2")
+    static uint32_t testAVX2(const Input &in, uint32_t count, List<CircleContact> &out) {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256 margin = _mm256_set1_ps(in.margin);
+
+        uint32_t k = 0;
+        for (; k + 8 <= count; k += 8) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.first + k));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.second + k));
+
+            const __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(in.x, b, 4), _mm256_i32gather_ps(in.x, a, 4));
+            const __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(in.y, b, 4), _mm256_i32gather_ps(in.y, a, 4));
+            const __m256 radii = _mm256_add_ps(_mm256_i32gather_ps(in.radius, a, 4),
+                                               _mm256_i32gather_ps(in.radius, b, 4));
+            const __m256 reach = _mm256_add_ps(radii, margin);
+            const __m256 dist_sq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+            const uint32_t mask = _mm256_movemask_ps(_mm256_cmp_ps(dist_sq, _mm256_mul_ps(reach, reach), _CMP_LT_OQ));
+            if (!mask)
+                continue;
+
+            const __m256 dist = _mm256_sqrt_ps(dist_sq);
+            const __m256 length = _mm256_blendv_ps(dist, one, _mm256_cmp_ps(dist, zero, _CMP_EQ_OQ));
+
+            alignas(32) float nx[8], ny[8], depth[8];
+            _mm256_store_ps(nx, _mm256_div_ps(dx, length));
+            _mm256_store_ps(ny, _mm256_div_ps(dy, length));
+            _mm256_store_ps(depth, _mm256_sub_ps(radii, dist));
+            emit(k, mask, nx, ny, depth, out);
+        }
+        return k;
+    }
+
+    PARTICLES_TARGET("sse2")
+    static uint32_t testSSE(const Input &in, uint32_t count, List<CircleContact> &out) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 margin = _mm_set1_ps(in.margin);
+
+        uint32_t k = 0;
+        for (; k + 4 <= count; k += 4) {
+            const uint32_t* a = in.first + k;
+            const uint32_t* b = in.second + k;
+
+            // no gather before avx2
+            const __m128 dx = _mm_sub_ps(_mm_setr_ps(in.x[b[0]], in.x[b[1]], in.x[b[2]], in.x[b[3]]),
+                                         _mm_setr_ps(in.x[a[0]], in.x[a[1]], in.x[a[2]], in.x[a[3]]));
+            const __m128 dy = _mm_sub_ps(_mm_setr_ps(in.y[b[0]], in.y[b[1]], in.y[b[2]], in.y[b[3]]),
+                                         _mm_setr_ps(in.y[a[0]], in.y[a[1]], in.y[a[2]], in.y[a[3]]));
+            const __m128 radii = _mm_add_ps(
+                _mm_setr_ps(in.radius[a[0]], in.radius[a[1]], in.radius[a[2]], in.radius[a[3]]),
+                _mm_setr_ps(in.radius[b[0]], in.radius[b[1]], in.radius[b[2]], in.radius[b[3]]));
+            const __m128 reach = _mm_add_ps(radii, margin);
+            const __m128 dist_sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+            const uint32_t mask = _mm_movemask_ps(_mm_cmplt_ps(dist_sq, _mm_mul_ps(reach, reach)));
+            if (!mask)
+                continue;
+
+            const __m128 dist = _mm_sqrt_ps(dist_sq);
+            const __m128 is_zero = _mm_cmpeq_ps(dist, zero);
+            const __m128 length = _mm_or_ps(_mm_and_ps(is_zero, one), _mm_andnot_ps(is_zero, dist));
+
+            alignas(16) float nx[4], ny[4], depth[4];
+            _mm_store_ps(nx, _mm_div_ps(dx, length));
+            _mm_store_ps(ny, _mm_div_ps(dy, length));
+            _mm_store_ps(depth, _mm_sub_ps(radii, dist));
+            emit(k, mask, nx, ny, depth, out);
+        }
+        return k;
+    }
+#endif
+
+#if defined(PARTICLES_SIMD_NEON)
+    static uint32_t testNEON(const Input &in, uint32_t count, List<CircleContact> &out) {
+        const uint32x4_t lane_bits = {1, 2, 4, 8};
+
+        uint32_t k = 0;
+        for (; k + 4 <= count; k += 4) {
+            const uint32_t* a = in.first + k;
+            const uint32_t* b = in.second + k;
+
+            alignas(16) float ax[4], ay[4], ar[4], bx[4], by[4], br[4];
+            for (uint32_t lane = 0; lane < 4; ++lane) {
+                ax[lane] = in.x[a[lane]];
+                ay[lane] = in.y[a[lane]];
+                ar[lane] = in.radius[a[lane]];
+                bx[lane] = in.x[b[lane]];
+                by[lane] = in.y[b[lane]];
+                br[lane] = in.radius[b[lane]];
+            }
+
+            const float32x4_t dx = vsubq_f32(vld1q_f32(bx), vld1q_f32(ax));
+            const float32x4_t dy = vsubq_f32(vld1q_f32(by), vld1q_f32(ay));
+            const float32x4_t radii = vaddq_f32(vld1q_f32(ar), vld1q_f32(br));
+            const float32x4_t reach = vaddq_f32(radii, vdupq_n_f32(in.margin));
+            const float32x4_t dist_sq = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+
+            const uint32_t mask = vaddvq_u32(vandq_u32(vcltq_f32(dist_sq, vmulq_f32(reach, reach)), lane_bits));
+            if (!mask)
+                continue;
+
+            const float32x4_t dist = vsqrtq_f32(dist_sq);
+            const float32x4_t length = vbslq_f32(vceqq_f32(dist, vdupq_n_f32(0.f)), vdupq_n_f32(1.f), dist);
+
+            alignas(16) float nx[4], ny[4], depth[4];
+            vst1q_f32(nx, vdivq_f32(dx, length));
+            vst1q_f32(ny, vdivq_f32(dy, length));
+            vst1q_f32(depth, vsubq_f32(radii, dist));
+            emit(k, mask, nx, ny, depth, out);
+        }
+        return k;
+    }
+#endif
+
+ public:
+    // tests (first[k], second[k]) for every k, both rows must hold circles.
+    // contacts are appended to out in pair order, whatever the level. pairs less than margin apart are
+    // speculative contacts, see Solver::setSpeculativeContacts
+    static void collide(const BodyStore &store, std::span<const uint32_t> first, std::span<const uint32_t> second,
+                        List<CircleContact> &out, SimdLevel level = Simd::best(), float margin = 0.f) {
+        const Input in{store.position_x.data(), store.position_y.data(), store.radius.data(),
+                       first.data(), second.data(), margin};
+        const auto count = static_cast<uint32_t>(first.size());
+
+        uint32_t done = 0;
+        switch (level) {
+#if defined(PARTICLES_SIMD_X86)
+            case SIMD_AVX2:
+                done = testAVX2(in, count, out);
+                break;
+            case SIMD_SSE:
+                done = testSSE(in, count, out);
+                break;
+#endif
+#if defined(PARTICLES_SIMD_NEON)
+            case SIMD_NEON:
+                done = testNEON(in, count, out);
+                break;
+#endif
+            default:
+                break;
+        }
+
+        testScalar(in, done, count, out);
+    }
+};
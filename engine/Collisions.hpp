@@ -1,8 +1,24 @@
 #pragma once
 
+#include <span>
+
 #include "common/Body.hpp"
+#include "Gjk.hpp"
 #include "../utils/math.hpp"
 
+// one point of a manifold, with its sequential impulse state, see ContactSolver
+struct ContactPoint {
+    uint32_t feature = 0;           // Manifold::feature and what made this point, warm starting matches on it
+    float depth = 0.f;
+    Vec2 offset_a, offset_b;        // from the body positions to the point
+    float normal_impulse = 0.f;     // accumulated over the iterations, warm started from the last substep
+    float tangent_impulse = 0.f;
+    float normal_mass = 0.f;
+    float tangent_mass = 0.f;
+    float velocity_bias = 0.f;      // pushes the penetration out
+    float bounce = 0.f;             // separating speed restitution asks for, 0 for resting contacts
+};
+
 struct Manifold {
     Body* bodyA = nullptr;
     Body* bodyB = nullptr;
@@ -12,22 +28,345 @@ struct Manifold {
     Vec2 contact1;
     Vec2 contact2;
     uint32_t contact_count = 0;
+    uint32_t feature = 0;       // the edge or vertex that gave the normal, stays the same while the contact lasts
+    ContactPoint points[2];     // for contact1 and contact2
+    float friction = 0.f;
+    float normal_matrix[3] = {};    // k11, k12, k22 when both points are solved as one, zeros otherwise
 
     Manifold() = default;
     Manifold(Body* a, Body* b, Vec2 normal, float depth)
         : bodyA(a), bodyB(b), normal(normal), depth(depth) {}
     Manifold(Body* a, Body* b, Vec2 normal, float depth, Vec2 contact1, Vec2 contact2, uint32_t contact_count)
-        : bodyA(a), bodyB(b), normal(normal), depth(depth), contact1(contact1), contact2(contact2), contact_count(contact_count) {}
+        : bodyA(a), bodyB(b), normal(normal), depth(depth), contact1(contact1), contact2(contact2), contact_count(contact_count) {
+        points[0].depth = points[1].depth = depth;
+    }
 
     void setBody(Body* a, Body* b) {
         bodyA = a;
         bodyB = b;
     }
+
+    [[nodiscard]] Vec2 contact(uint32_t index) const {
+        return index == 0 ? contact1 : contact2;
+    }
+};
+
+// how a pair of shapes is tested, see Solver::setNarrowphase
+enum NarrowphaseType {
+    SAT,        // separating axes, every edge normal of both shapes
+    GJK_EPA     // distance and penetration from support points, cost grows with the vertex count only
 };
 
 class Collisions {
  public:
-    static std::pair<float, float> projectPolygon(const List<Vec2> &vertices, Vec2 axis) {
+    // Manifold::feature is the index of the edge whose normal separated the least,
+    // with one of these bits set when it belongs to the second body or is a vertex
+    static constexpr uint32_t FEATURE_OF_B = 1u << 16;
+    static constexpr uint32_t FEATURE_VERTEX = 1u << 17;
+    // ContactPoint::feature adds what made the point above POINT_SHIFT: the index of the incident vertex,
+    // or the side of the reference face that cut the incident edge together with that edge's index
+    static constexpr uint32_t POINT_SHIFT = 18;
+    static constexpr uint32_t CLIPPED_FIRST = 1u << 12;
+    static constexpr uint32_t CLIPPED_SECOND = 2u << 12;
+    // clipped points this far in front of the reference face still count, in px, so a face resting
+    // a little crooked keeps both its points instead of rocking between them
+    static constexpr float POINT_TOLERANCE = 0.5f;
+    static constexpr float CLIP_TOLERANCE = 0.25f;      // in px, see clipSegment
+    // a face of b has to beat the faces of a by this much, in px, to become the reference face. two resting
+    // faces overlap by about the same on either axis, and a reference face switching sides resets the features
+    static constexpr float REFERENCE_TOLERANCE = 0.1f;
+    static constexpr float REFERENCE_ALIGNMENT = 1e-3f;     // the same for intersectConvex, which compares cosines
+    static constexpr uint32_t TOI_ITERATIONS = 20;
+    static constexpr float TOI_TOLERANCE = 0.05f;           // in px, a gap this small counts as touching
+
+ private:
+    using CollisionHandler = bool (*)(Body* a, Body* b, Manifold &out);
+
+    struct ClipPoint {
+        Vec2 point;
+        uint32_t id;
+    };
+
+    // keeps the part of the segment in where normal * p <= offset, a cut end gets clip_id. an end just past the
+    // plane is kept whole, boxes stacked flush would otherwise switch between the vertex and the cut with round off
+    static uint32_t clipSegment(const ClipPoint (&in)[2], ClipPoint (&out)[2], Vec2 normal, float offset,
+                                uint32_t clip_id) {
+        uint32_t count = 0;
+        const float d0 = normal * in[0].point - offset;
+        const float d1 = normal * in[1].point - offset;
+        const bool keep0 = d0 <= CLIP_TOLERANCE, keep1 = d1 <= CLIP_TOLERANCE;
+        if (keep0)
+            out[count++] = in[0];
+        if (keep1)
+            out[count++] = in[1];
+        if (keep0 != keep1 && d0 * d1 < 0.f)
+            out[count++] = {in[0].point + (in[1].point - in[0].point) * (d0 / (d0 - d1)), clip_id};
+        return count;
+    }
+
+    // of vertices the support point, of normals the face facing direction most
+    static uint32_t furthestAlong(std::span<const Vec2> vectors, Vec2 direction) {
+        uint32_t best = 0;
+        float best_projection = vectors[0] * direction;
+        for (uint32_t i = 1; i < vectors.size(); ++i) {
+            const float projection = vectors[i] * direction;
+            if (projection > best_projection) {
+                best = i;
+                best_projection = projection;
+            }
+        }
+        return best;
+    }
+
+    // the face of the polygon owning the separating axis that faces the other one is the reference face,
+    // the face of the other polygon facing it most the incident face. the incident face is clipped to the
+    // sides of the reference face, and what is left behind the reference face, or no further than tolerance
+    // in front of it, is in contact
+    static void clipPolygons(std::span<const Vec2> vertices_a, std::span<const Vec2> normals_a,
+                             std::span<const Vec2> vertices_b, std::span<const Vec2> normals_b, Manifold &out,
+                             float tolerance = POINT_TOLERANCE) {
+        const bool flip = out.feature & FEATURE_OF_B;
+        std::span<const Vec2> ref_vertices = flip ? vertices_b : vertices_a;
+        std::span<const Vec2> ref_normals = flip ? normals_b : normals_a;
+        std::span<const Vec2> inc_vertices = flip ? vertices_a : vertices_b;
+        std::span<const Vec2> inc_normals = flip ? normals_a : normals_b;
+
+        const uint32_t ref = furthestAlong(ref_normals, flip ? -out.normal : out.normal);
+        const Vec2 ref_normal = ref_normals[ref];
+        const uint32_t inc = furthestAlong(inc_normals, -ref_normal);
+        const auto inc_next = static_cast<uint32_t>((inc + 1) % inc_vertices.size());
+
+        const Vec2 r1 = ref_vertices[ref];
+        const Vec2 r2 = ref_vertices[(ref + 1) % ref_vertices.size()];
+        const Vec2 side = Math::normalize(r2 - r1);
+
+        out.feature = (flip ? FEATURE_OF_B : 0) | ref;
+        const ClipPoint incident[2] = {{inc_vertices[inc], inc}, {inc_vertices[inc_next], inc_next}};
+        ClipPoint first[2], second[2];
+        if (clipSegment(incident, first, -side, -(side * r1), CLIPPED_FIRST | inc) < 2
+            || clipSegment(first, second, side, side * r2, CLIPPED_SECOND | inc) < 2) {
+            // only when the faces barely overlap, fall back to the deepest incident vertex
+            const ClipPoint &deepest = ref_normal * incident[0].point < ref_normal * incident[1].point ? incident[0] : incident[1];
+            second[0] = second[1] = deepest;
+        }
+
+        out.contact_count = 0;
+        for (const ClipPoint &point : second) {
+            const float separation = ref_normal * (point.point - r1);
+            if (separation > tolerance || (out.contact_count == 1 && point.id == second[0].id))
+                continue;
+
+            ContactPoint &contact = out.points[out.contact_count];
+            contact.feature = out.feature | point.id << POINT_SHIFT;
+            contact.depth = -separation;
+            (out.contact_count == 0 ? out.contact1 : out.contact2) = point.point;
+            out.contact_count++;
+        }
+
+        // the sat axis overlaps, a crooked face can still leave both points outside
+        if (out.contact_count == 0) {
+            out.contact_count = 1;
+            out.contact1 = second[0].point;
+            out.points[0].feature = out.feature | second[0].id << POINT_SHIFT;
+            out.points[0].depth = out.depth;
+        }
+    }
+
+    static bool collideCircles(Body* a, Body* b, Manifold &out) {
+        auto circle_a = static_cast<CircleBody*>(a);
+        auto circle_b = static_cast<CircleBody*>(b);
+        return intersectCircles(circle_a->position(), circle_a->radius(), circle_b->position(), circle_b->radius(), out);
+    }
+
+    static bool collideCircleAndPolygon(Body* a, Body* b, Manifold &out) {
+        auto circle = static_cast<CircleBody*>(a);
+        auto polygon = static_cast<PolygonBody*>(b);
+        return intersectCircleAndPolygon(circle->position(), circle->radius(),
+                                         polygon->position(), polygon->vertices(), polygon->normals(), out);
+    }
+
+    static bool collidePolygonAndCircle(Body* a, Body* b, Manifold &out) {
+        if (!collideCircleAndPolygon(b, a, out))
+            return false;
+
+        out.normal = -out.normal;
+        return true;
+    }
+
+    static bool collidePolygons(Body* a, Body* b, Manifold &out) {
+        auto polygon_a = static_cast<PolygonBody*>(a);
+        auto polygon_b = static_cast<PolygonBody*>(b);
+        return intersectPolygons(polygon_a->position(), polygon_a->vertices(), polygon_a->normals(),
+                                 polygon_b->position(), polygon_b->vertices(), polygon_b->normals(), out);
+    }
+
+    // a circle is its center with the radius around it, gjk only sees the center
+    static Vec2 coreSupport(const Body* body, Vec2 direction) {
+        if (body->shape() == CIRCLE)
+            return body->position();
+
+        std::span<const Vec2> vertices = static_cast<const PolygonBody*>(body)->vertices();
+        return vertices[furthestAlong(vertices, direction)];
+    }
+
+    static float coreRadius(const Body* body) {
+        return body->shape() == CIRCLE ? static_cast<const CircleBody*>(body)->radius() : 0.f;
+    }
+
+    // clipPolygons for a normal gjk or epa found: the face lining up best with it is the reference, b's only
+    // if clearly better. the normal becomes the face's, which is exact
+    static void clipAlong(const PolygonBody* a, const PolygonBody* b, Manifold &out, float tolerance) {
+        const uint32_t face_a = furthestAlong(a->normals(), out.normal);
+        const uint32_t face_b = furthestAlong(b->normals(), -out.normal);
+        const bool flip = b->normals()[face_b] * -out.normal > a->normals()[face_a] * out.normal + REFERENCE_ALIGNMENT;
+        out.feature = flip ? FEATURE_OF_B | face_b : face_a;
+        clipPolygons(a->vertices(), a->normals(), b->vertices(), b->normals(), out, tolerance);
+        out.normal = flip ? -b->normals()[face_b] : a->normals()[face_a];
+    }
+
+ public:
+    // narrowphase for any pair of bodies. on hit, out.normal points from a to b.
+    // on a miss between shapes other than two circles, out.normal is the axis that kept them apart
+    static bool collide(Body* a, Body* b, Manifold &out, NarrowphaseType type = SAT) {
+        static constexpr CollisionHandler handlers[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT] = {
+            /* CIRCLE  */ {collideCircles, collideCircleAndPolygon},
+            /* POLYGON */ {collidePolygonAndCircle, collidePolygons},
+        };
+
+        if (type == GJK_EPA)
+            return intersectConvex(a, b, out);
+        return handlers[a->shape()][b->shape()](a, b, out);
+    }
+
+    // the same results as the separating axis tests, from gjk between the cores of the shapes (polygons, and
+    // circles shrunk to their centers) with the radii added on top. only when the cores overlap too epa
+    // finds the way out. polygon pairs are clipped to their faces like intersectPolygons does
+    static bool intersectConvex(const Body* a, const Body* b, Manifold &out) {
+        auto support_a = [a](Vec2 direction) { return coreSupport(a, direction); };
+        auto support_b = [b](Vec2 direction) { return coreSupport(b, direction); };
+        const float radius_a = coreRadius(a), radius_b = coreRadius(b);
+
+        const Gjk::Distance distance = Gjk::distance(support_a, support_b, b->position() - a->position(),
+                                                     radius_a + radius_b);
+        if (!distance.overlap) {
+            out.normal = distance.axis;
+            if (distance.distance >= radius_a + radius_b)
+                return false;
+
+            out.depth = radius_a + radius_b - distance.distance;
+            out.feature = 0;
+            out.contact_count = 1;
+            out.contact1 = radius_a > 0.f ? distance.point_a + out.normal * radius_a : distance.point_b - out.normal * radius_b;
+            out.points[0].feature = 0;
+            out.points[0].depth = out.depth;
+            return true;
+        }
+
+        const Gjk::Penetration penetration = Gjk::penetration(support_a, support_b, distance);
+        out.normal = penetration.normal;
+        out.depth = penetration.depth + radius_a + radius_b;
+        // within the tolerance a touching pair can look like one, epa then finds no depth
+        if (out.depth <= 0.f)
+            return false;
+
+        if (a->shape() == POLYGON && b->shape() == POLYGON) {
+            clipAlong(static_cast<const PolygonBody*>(a), static_cast<const PolygonBody*>(b), out, POINT_TOLERANCE);
+            return true;
+        }
+
+        out.feature = 0;
+        out.contact_count = 1;
+        out.contact1 = radius_a > 0.f ? penetration.point_a + out.normal * radius_a : penetration.point_b - out.normal * radius_b;
+        out.points[0].feature = 0;
+        out.points[0].depth = out.depth;
+        return true;
+    }
+
+    // a pair collide found apart, closer than margin, as a speculative contact: out.depth is minus the gap
+    // and the points are where the gap is smallest, on both faces for a pair of polygons. on a miss,
+    // out.normal is the axis that kept them apart
+    static bool speculate(const Body* a, const Body* b, float margin, Manifold &out) {
+        auto support_a = [a](Vec2 direction) { return coreSupport(a, direction); };
+        auto support_b = [b](Vec2 direction) { return coreSupport(b, direction); };
+        const float radius_a = coreRadius(a), radius_b = coreRadius(b);
+
+        const Gjk::Distance distance = Gjk::distance(support_a, support_b, b->position() - a->position(),
+                                                     radius_a + radius_b + margin);
+        const float gap = distance.distance - radius_a - radius_b;
+        out.normal = distance.axis;
+        // touching within the tolerance of gjk, but not for collide
+        if (distance.overlap)
+            return false;
+        if (gap >= margin)
+            return false;
+
+        out.depth = -gap;
+        if (a->shape() == POLYGON && b->shape() == POLYGON) {
+            // a face coming down flat gets both its points, not only the corner a hair closer
+            clipAlong(static_cast<const PolygonBody*>(a), static_cast<const PolygonBody*>(b), out, gap + POINT_TOLERANCE);
+            return true;
+        }
+
+        out.feature = 0;
+        out.contact_count = 1;
+        out.contact1 = radius_a > 0.f ? distance.point_a + out.normal * radius_a : distance.point_b - out.normal * radius_b;
+        out.points[0].feature = 0;
+        out.points[0].depth = out.depth;
+        return true;
+    }
+
+    // when, within dt, a and b moving at their velocities have gone depth into each other past touching.
+    // infinity when that does not happen, or when even their cores overlap, which is left to the contact
+    // solver. conservative advancement on the gjk distance: under translation the distance is convex in
+    // time, so stepping by gap over closing speed never passes the impact. the bodies keep their angles,
+    // a rotation over one substep rarely matters next to the speeds this is for
+    static float timeOfImpact(const Body* a, Vec2 velocity_a, const Body* b, Vec2 velocity_b, float dt, float depth) {
+        const Vec2 velocity = velocity_b - velocity_a;      // a is held still
+        float t = 0.f;
+        auto support_a = [a](Vec2 direction) { return coreSupport(a, direction); };
+        auto support_b = [b, velocity, &t](Vec2 direction) { return coreSupport(b, direction) + velocity * t; };
+        const float radii = coreRadius(a) + coreRadius(b);
+
+        Vec2 direction = b->position() - a->position();
+        for (uint32_t i = 0; i < TOI_ITERATIONS; ++i) {
+            const Gjk::Distance distance = Gjk::distance(support_a, support_b, direction);
+            if (distance.overlap)
+                return i == 0 ? std::numeric_limits<float>::infinity() : t;
+
+            // no closer along the closest axis means no closer ever
+            const float gap = distance.distance - radii;
+            const float closing = -(velocity * distance.axis);
+            if (closing <= 0.f)
+                return std::numeric_limits<float>::infinity();
+            // already touching goes depth further from where it is, what the contact solver did not stop
+            if (gap <= TOI_TOLERANCE)
+                return t + (std::max(gap, 0.f) + depth) / closing;
+
+            t += gap / closing;
+            if (t >= dt)
+                return std::numeric_limits<float>::infinity();
+            direction = distance.axis;
+        }
+        // still short of the impact, which is safe to stop at
+        return t;
+    }
+
+    static std::pair<float, float> projectBody(const Body* body, Vec2 axis) {
+        if (body->shape() == CIRCLE) {
+            auto circle = static_cast<const CircleBody*>(body);
+            return projectCircle(circle->position(), circle->radius(), axis);
+        }
+        return projectPolygon(static_cast<const PolygonBody*>(body)->vertices(), axis);
+    }
+
+    // whether axis still keeps a and b apart, by at least margin, which spares a separated pair the full test
+    static bool separatedAlong(const Body* a, const Body* b, Vec2 axis, float margin = 0.f) {
+        auto [min_a, max_a] = projectBody(a, axis);
+        auto [min_b, max_b] = projectBody(b, axis);
+        return max_b + margin <= min_a || max_a + margin <= min_b;
+    }
+
+    static std::pair<float, float> projectPolygon(std::span<const Vec2> vertices, Vec2 axis) {
         float min_a = axis * vertices[0];
         float max_a = min_a;
 
@@ -48,30 +387,12 @@ class Collisions {
         return {std::min(p1, p2), std::max(p1, p2)};
     }
 
-    static void resolveCollision(Manifold& manifold) {
-        Vec2 v_ab = manifold.bodyB->velocity() - manifold.bodyA->velocity();
-        if (v_ab * manifold.normal > 0.f)
-            return;
-
-        float e = manifold.bodyA->material().restitution * manifold.bodyB->material().restitution;
-        float inv_m_a = manifold.bodyA->inverseMass();
-        float inv_m_b = manifold.bodyB->inverseMass();
-
-        float j = -((1 + e) * v_ab * manifold.normal) / (manifold.normal * manifold.normal * (inv_m_a + inv_m_b));
-
-        manifold.bodyA->setVelocity(manifold.bodyA->velocity() - (j * inv_m_a) * manifold.normal);
-        manifold.bodyB->setVelocity(manifold.bodyB->velocity() + (j * inv_m_b) * manifold.normal);
-//        std::cout << j << "|" << bodyA.velocity << "|" << bodyB.velocity << std::endl;
-
-//        manifold.bodyA->setAngularVelocity()
-    }
-
-    static int findClosestPoint(Vec2 point, List<Vec2> vertices) {
+    static int findClosestPoint(Vec2 point, std::span<const Vec2> vertices) {
         float min_dist = std::numeric_limits<float>::infinity();
         int closest = 0;
 
         for (int i = 0; i < vertices.size(); ++i) {
-            float dist = std::abs(point - vertices[i]);
+            float dist = Math::lengthSquared(point - vertices[i]);
             if (dist < min_dist) {
                 min_dist = dist;
                 closest = i;
@@ -90,22 +411,24 @@ class Collisions {
 
         out.normal = Math::normalize(ab);
         out.depth = (radius_a + radius_b) - dist;
+        out.feature = 0;
         out.contact_count = 1;
         out.contact1 = center_a + out.normal * radius_a;
+        out.points[0].feature = 0;
+        out.points[0].depth = out.depth;
 
         return true;
     }
 
-    static bool intersectPolygons(Vec2 center_a, List<Vec2> vertices_a, Vec2 center_b, List<Vec2> vertices_b, Manifold &out) {
+    // normals_x[i] is the outward unit normal of the edge (i, i + 1)
+    static bool intersectPolygons(Vec2 center_a, std::span<const Vec2> vertices_a, std::span<const Vec2> normals_a,
+                                  Vec2 center_b, std::span<const Vec2> vertices_b, std::span<const Vec2> normals_b,
+                                  Manifold &out) {
         out.normal = Vec2{};
         out.depth = std::numeric_limits<float>::infinity();
 
-        for (int i = 0; i < vertices_a.size(); ++i) {
-            Vec2 v_a = vertices_a[i];
-            Vec2 v_b = vertices_a[(i + 1) % vertices_a.size()];
-
-            Vec2 edge = v_b - v_a;
-            Vec2 axis = Math::normalize(Vec2{edge.y, -edge.x});
+        for (uint32_t i = 0; i < normals_a.size(); ++i) {
+            const Vec2 &axis = normals_a[i];
 
             // min/max projection for A
             auto [min_a, max_a] = projectPolygon(vertices_a, axis);
@@ -113,22 +436,21 @@ class Collisions {
             // min/max projection for B
             auto [min_b, max_b] = projectPolygon(vertices_b, axis);
 
-            if (max_b <= min_a || max_a <= min_b)
+            if (max_b <= min_a || max_a <= min_b) {
+                out.normal = axis;
                 return false;
+            }
 
             float overlap = std::min(max_b - min_a, max_a - min_b);
             if (overlap < out.depth) {
                 out.depth = overlap;
                 out.normal = axis;
+                out.feature = i;
             }
         }
 
-        for (int i = 0; i < vertices_b.size(); ++i) {
-            Vec2 v_a = vertices_b[i];
-            Vec2 v_b = vertices_b[(i + 1) % vertices_b.size()];
-
-            Vec2 edge = v_b - v_a;
-            Vec2 axis = Math::normalize(Vec2{edge.y, -edge.x});
+        for (uint32_t i = 0; i < normals_b.size(); ++i) {
+            const Vec2 &axis = normals_b[i];
 
             // min/max projection for A
             auto [min_a, max_a] = projectPolygon(vertices_a, axis);
@@ -136,13 +458,16 @@ class Collisions {
             // min/max projection for B
             auto [min_b, max_b] = projectPolygon(vertices_b, axis);
 
-            if (max_b <= min_a || max_a <= min_b)
+            if (max_b <= min_a || max_a <= min_b) {
+                out.normal = axis;
                 return false;
+            }
 
             float overlap = std::min(max_b - min_a, max_a - min_b);
-            if (overlap < out.depth) {
+            if (overlap + REFERENCE_TOLERANCE < out.depth) {
                 out.depth = overlap;
                 out.normal = axis;
+                out.feature = FEATURE_OF_B | i;
             }
         }
 
@@ -150,18 +475,18 @@ class Collisions {
         if (direction * out.normal < 0)
             out.normal = -out.normal;
 
+        clipPolygons(vertices_a, normals_a, vertices_b, normals_b, out);
         return true;
     }
 
-    static bool intersectCircleAndPolygon(Vec2 center_circle, float radius, Vec2 center_poly, List<Vec2> vertices, Manifold &out) {
+    static bool intersectCircleAndPolygon(Vec2 center_circle, float radius, Vec2 center_poly,
+                                          std::span<const Vec2> vertices, std::span<const Vec2> normals,
+                                          Manifold &out) {
         out.normal = Vec2{};
         out.depth = std::numeric_limits<float>::infinity();
 
-        for (int i = 0; i < vertices.size(); ++i) {
-            Vec2 v_a = vertices[i];
-            Vec2 v_b = vertices[(i + 1) % vertices.size()];
-            Vec2 edge = v_b - v_a;
-            Vec2 axis = Math::normalize(Vec2{edge.y, -edge.x});
+        for (uint32_t i = 0; i < normals.size(); ++i) {
+            const Vec2 &axis = normals[i];
 
             // min/max projection for poly
             auto [min_p, max_p] = projectPolygon(vertices, axis);
@@ -169,13 +494,16 @@ class Collisions {
             // min/max projection for circle
             auto [min_c, max_c] = projectCircle(center_circle, radius, axis);
 
-            if (max_c <= min_p || max_p <= min_c)
+            if (max_c <= min_p || max_p <= min_c) {
+                out.normal = axis;
                 return false;
+            }
 
             float overlap = std::min(max_c - min_p, max_p - min_c);
             if (overlap < out.depth) {
                 out.depth = overlap;
                 out.normal = axis;
+                out.feature = i;
             }
         }
 
@@ -189,19 +517,27 @@ class Collisions {
         // min/max projection for circle
         auto [min_c, max_c] = projectCircle(center_circle, radius, axis);
 
-        if (max_c <= min_p || max_p <= min_c)
+        if (max_c <= min_p || max_p <= min_c) {
+            out.normal = axis;
             return false;
+        }
 
         float overlap = std::min(max_c - min_p, max_p - min_c);
         if (overlap < out.depth) {
             out.depth = overlap;
             out.normal = axis;
+            out.feature = FEATURE_VERTEX | closest;
         }
 
         Vec2 direction = center_poly - center_circle;
         if (direction * out.normal < 0)
             out.normal = -out.normal;
 
+        // the deepest point of the circle
+        out.contact_count = 1;
+        out.contact1 = center_circle + out.normal * radius;
+        out.points[0].feature = out.feature;
+        out.points[0].depth = out.depth;
         return true;
     }
 };
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+#include "common/Body.hpp"
+#include "../utils/math.hpp"
+
+// distance (gjk) and penetration (epa) between two convex shapes that are only seen through their support
+// functions, support(d) being the point of the shape furthest along d. both work on the minkowski difference
+// a - b, which holds the origin exactly when the shapes overlap. nothing is allocated, the epa polygon has a
+// fixed size and the search stops early instead of growing it.
+class Gjk {
+ public:
+    static constexpr uint32_t MAX_ITERATIONS = 32;
+    static constexpr uint32_t MAX_EPA_VERTICES = 64;
+    static constexpr float TOLERANCE = 1e-3f;       // in px, progress smaller than this ends a search
+
+    // a point of the difference with the two support points it came from
+    struct Vertex {
+        Vec2 a, b;
+        Vec2 w;     // a - b
+    };
+
+    struct Distance {
+        bool overlap = false;       // the origin is inside, distance and the points mean nothing then
+        float distance = 0.f;
+        Vec2 point_a, point_b;      // the closest points of the shapes
+        Vec2 axis;                  // from a to b, the shapes are at least distance apart along it
+        Vertex simplex[3];          // what the search ended with, penetration starts from it
+        uint32_t count = 0;
+    };
+
+    struct Penetration {
+        Vec2 normal;                // from a to b, moving b along it by depth separates them
+        float depth = 0.f;
+        Vec2 point_a, point_b;      // the deepest points of the shapes
+    };
+
+ private:
+    template <typename SupportA, typename SupportB>
+    static Vertex vertex(const SupportA &support_a, const SupportB &support_b, Vec2 direction) {
+        Vertex v;
+        v.a = support_a(direction);
+        v.b = support_b(-direction);
+        v.w = v.a - v.b;
+        return v;
+    }
+
+    // reduces the simplex to the smallest part holding its point closest to the origin, lambda are the
+    // barycentric weights of that point. false when a triangle holds the origin
+    static bool reduce(Vertex (&simplex)[3], uint32_t &count, float (&lambda)[3]) {
+        if (count == 1) {
+            lambda[0] = 1.f;
+            return true;
+        }
+
+        const Vec2 w1 = simplex[0].w, w2 = simplex[1].w;
+        const Vec2 e12 = w2 - w1;
+        const float d12_1 = w2 * e12, d12_2 = -(w1 * e12);
+
+        if (count == 2) {
+            if (d12_2 <= 0.f) {
+                count = 1;
+                lambda[0] = 1.f;
+            }
+            else if (d12_1 <= 0.f) {
+                simplex[0] = simplex[1];
+                count = 1;
+                lambda[0] = 1.f;
+            }
+            else {
+                lambda[0] = d12_1 / (d12_1 + d12_2);
+                lambda[1] = d12_2 / (d12_1 + d12_2);
+            }
+            return true;
+        }
+
+        // voronoi regions of the triangle's vertices, edges and inside
+        const Vec2 w3 = simplex[2].w;
+        const Vec2 e13 = w3 - w1, e23 = w3 - w2;
+        const float d13_1 = w3 * e13, d13_2 = -(w1 * e13);
+        const float d23_1 = w3 * e23, d23_2 = -(w2 * e23);
+        const float n123 = Math::cross(e12, e13);
+        const float d123_1 = n123 * Math::cross(w2, w3);
+        const float d123_2 = n123 * Math::cross(w3, w1);
+        const float d123_3 = n123 * Math::cross(w1, w2);
+
+        if (d12_2 <= 0.f && d13_2 <= 0.f) {
+            count = 1;
+            lambda[0] = 1.f;
+        }
+        else if (d12_1 > 0.f && d12_2 > 0.f && d123_3 <= 0.f) {
+            count = 2;
+            lambda[0] = d12_1 / (d12_1 + d12_2);
+            lambda[1] = d12_2 / (d12_1 + d12_2);
+        }
+        else if (d13_1 > 0.f && d13_2 > 0.f && d123_2 <= 0.f) {
+            simplex[1] = simplex[2];
+            count = 2;
+            lambda[0] = d13_1 / (d13_1 + d13_2);
+            lambda[1] = d13_2 / (d13_1 + d13_2);
+        }
+        else if (d12_1 <= 0.f && d23_2 <= 0.f) {
+            simplex[0] = simplex[1];
+            count = 1;
+            lambda[0] = 1.f;
+        }
+        else if (d13_1 <= 0.f && d23_1 <= 0.f) {
+            simplex[0] = simplex[2];
+            count = 1;
+            lambda[0] = 1.f;
+        }
+        else if (d23_1 > 0.f && d23_2 > 0.f && d123_1 <= 0.f) {
+            simplex[0] = simplex[2];
+            count = 2;
+            lambda[0] = d23_1 / (d23_1 + d23_2);
+            lambda[1] = d23_2 / (d23_1 + d23_2);
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+    static void witness(Distance &out, const float (&lambda)[3]) {
+        out.point_a = out.point_b = Vec2{};
+        for (uint32_t k = 0; k < out.count; ++k) {
+            out.point_a += out.simplex[k].a * lambda[k];
+            out.point_b += out.simplex[k].b * lambda[k];
+        }
+    }
+
+    template <typename SupportA, typename SupportB>
+    static bool widen(const SupportA &support_a, const SupportB &support_b, Distance &out) {
+        const Vec2 edge = out.simplex[1].w - out.simplex[0].w;
+        const Vec2 side = Math::normalize(Vec2{-edge.y, edge.x});
+        for (const Vec2 direction : {side, -side}) {
+            const Vertex next = vertex(support_a, support_b, direction);
+            if (next.w * direction > TOLERANCE) {
+                out.simplex[out.count++] = next;
+                return true;
+            }
+        }
+        return false;
+    }
+
+ public:
+    // closest points of the two shapes, starting the search along direction (any guess, b - a works well).
+    // once an axis shows them more than margin apart the search stops there, distance is then only how far
+    // apart they are along that axis
+    template <typename SupportA, typename SupportB>
+    static Distance distance(const SupportA &support_a, const SupportB &support_b, Vec2 direction,
+                             float margin = std::numeric_limits<float>::infinity()) {
+        Distance out;
+        if (direction == Vec2{})
+            direction = {1.f, 0.f};
+        out.axis = Math::normalize(direction);
+        out.simplex[0] = vertex(support_a, support_b, direction);
+        out.count = 1;
+
+        float lambda[3] = {};
+        for (uint32_t i = 0; i < MAX_ITERATIONS; ++i) {
+            if (!reduce(out.simplex, out.count, lambda)) {
+                out.overlap = true;
+                return out;
+            }
+
+            Vec2 closest{};
+            for (uint32_t k = 0; k < out.count; ++k)
+                closest += out.simplex[k].w * lambda[k];
+            const float closest_sq = Math::lengthSquared(closest);
+            if (closest_sq < TOLERANCE * TOLERANCE) {
+                // the origin is on the simplex. a vertex there means the shapes only touch, which counts as apart
+                // like in the separating axis tests. a segment through it may cut right across the difference,
+                // then a point to either side of it makes a triangle holding the origin
+                if (out.count == 2 && widen(support_a, support_b, out)) {
+                    out.overlap = true;
+                    return out;
+                }
+                break;
+            }
+
+            // -closest points from a to b, and the support point along it bounds the gap from below
+            const Vertex next = vertex(support_a, support_b, -closest);
+            const float length = std::sqrt(closest_sq);
+            const float gap = next.w * closest / length;
+            if (gap > margin) {
+                witness(out, lambda);
+                out.distance = gap;
+                out.axis = -closest / length;
+                return out;
+            }
+            // stop once the support point gets no closer to the origin than the simplex already is
+            if (length - gap <= TOLERANCE)
+                break;
+
+            const bool repeated = std::any_of(out.simplex, out.simplex + out.count, [&](const Vertex &v) {
+                return v.w == next.w;
+            });
+            if (repeated)
+                break;
+            out.simplex[out.count++] = next;
+        }
+
+        // again, in case the iterations ran out right after adding a vertex
+        if (!reduce(out.simplex, out.count, lambda)) {
+            out.overlap = true;
+            return out;
+        }
+        witness(out, lambda);
+        out.distance = Math::length(out.point_b - out.point_a);
+        if (out.distance > 0.f)
+            out.axis = (out.point_b - out.point_a) / out.distance;
+        return out;
+    }
+
+    // the shortest way out for two shapes distance found overlapping: expands its triangle towards the
+    // boundary of the difference until the edge closest to the origin cannot be pushed further
+    template <typename SupportA, typename SupportB>
+    static Penetration penetration(const SupportA &support_a, const SupportB &support_b, const Distance &found) {
+        Vertex polygon[MAX_EPA_VERTICES];
+        Vec2 normals[MAX_EPA_VERTICES];     // of the edge (i, i + 1), with its distance from the origin
+        float distances[MAX_EPA_VERTICES];
+        uint32_t count = 3;
+        std::copy_n(found.simplex, 3, polygon);
+        // counter-clockwise, so (e.y, -e.x) of an edge e points out
+        if (Math::cross(polygon[1].w - polygon[0].w, polygon[2].w - polygon[0].w) < 0.f)
+            std::swap(polygon[1], polygon[2]);
+
+        auto updateEdge = [&](uint32_t i) {
+            const Vec2 edge = polygon[(i + 1) % count].w - polygon[i].w;
+            normals[i] = Math::normalize(Vec2{edge.y, -edge.x});
+            distances[i] = normals[i] * polygon[i].w;
+        };
+        for (uint32_t i = 0; i < count; ++i)
+            updateEdge(i);
+
+        for (;;) {
+            const auto closest = static_cast<uint32_t>(std::min_element(distances, distances + count) - distances);
+            const Vertex next = vertex(support_a, support_b, normals[closest]);
+            const bool converged = next.w * normals[closest] - distances[closest] <= TOLERANCE;
+            if (converged || count == MAX_EPA_VERTICES) {
+                // where the origin projects onto the closest edge
+                const Vertex &v1 = polygon[closest];
+                const Vertex &v2 = polygon[(closest + 1) % count];
+                const Vec2 edge = v2.w - v1.w;
+                const float length_sq = Math::lengthSquared(edge);
+                const float t = length_sq > 0.f ? std::clamp(-(v1.w * edge) / length_sq, 0.f, 1.f) : 0.f;
+
+                // out of a - b along the normal is where b has to go
+                Penetration out;
+                out.normal = normals[closest];
+                out.depth = distances[closest];
+                out.point_a = v1.a + (v2.a - v1.a) * t;
+                out.point_b = v1.b + (v2.b - v1.b) * t;
+                return out;
+            }
+
+            // the new vertex splits the closest edge in two, the others keep their normals
+            std::copy_backward(polygon + closest + 1, polygon + count, polygon + count + 1);
+            std::copy_backward(normals + closest + 1, normals + count, normals + count + 1);
+            std::copy_backward(distances + closest + 1, distances + count, distances + count + 1);
+            polygon[closest + 1] = next;
+            count++;
+            updateEdge(closest);
+            updateEdge(closest + 1);
+        }
+    }
+};
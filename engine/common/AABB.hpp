@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+
+struct AABB {
+    sf::Vector2f min;
+    sf::Vector2f max;
+
+    [[nodiscard]] bool overlaps(const AABB &other) const {
+        return min.x <= other.max.x && other.min.x <= max.x
+            && min.y <= other.max.y && other.min.y <= max.y;
+    }
+
+    [[nodiscard]] bool contains(const AABB &other) const {
+        return min.x <= other.min.x && min.y <= other.min.y
+            && other.max.x <= max.x && other.max.y <= max.y;
+    }
+
+    [[nodiscard]] sf::Vector2f size() const {
+        return max - min;
+    }
+
+    [[nodiscard]] float perimeter() const {
+        return 2.f * ((max.x - min.x) + (max.y - min.y));
+    }
+
+    [[nodiscard]] AABB merged(const AABB &other) const {
+        return {{std::min(min.x, other.min.x), std::min(min.y, other.min.y)},
+                {std::max(max.x, other.max.x), std::max(max.y, other.max.y)}};
+    }
+
+    [[nodiscard]] AABB expanded(float margin) const {
+        return {{min.x - margin, min.y - margin}, {max.x + margin, max.y + margin}};
+    }
+};
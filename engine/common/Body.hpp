@@ -6,6 +6,8 @@
 
 #include "Material.hpp"
 #include "Shape.hpp"
+#include "AABB.hpp"
+#include "BodyStore.hpp"
 #include "../../utils/math.hpp"
 #include "../../utils/colors.hpp"
 
@@ -15,143 +17,224 @@ using Vec2 = sf::Vector2f;
 using Vec3 = sf::Vector3f;
 
 class Body {
+    friend class BodyStore;
+
  protected:
-    Vec2 m_force;
-    Vec2 m_position;
-    Vec2 m_velocity;
-    Vec2 m_acceleration;
-    float m_angular_acceleration = 0.f;
-    float m_angular_velocity = 0.f;
-    float m_angle = 0.f;
+    // position, velocity, angle, forces and the world-space aabb live in a row of m_store, or in m_state
+    // while the body is in no store
+    BodyStore* m_store = nullptr;
+    BodyHandle m_handle;
+    uint32_t m_row = 0;
+    BodyState m_state;
     const Material m_material;
     const ShapeType m_shape;
     sf::Color m_color = m_material.color;
     sf::Color m_outline_color = whiteOrBlack(m_color);
     bool m_is_static = false;
-    float m_max_speed = std::numeric_limits<float>::infinity();
-    float m_max_angular_speed = std::numeric_limits<float>::infinity();
+    float m_mass = 0.f;
+    float m_inverse_mass = 0.f;
+    float m_inertia = 0.f;
+    float m_inverse_inertia = 0.f;
+
+    // a field of the body's row of m_store, or of m_state
+    template <typename T>
+    T &state(std::vector<T> BodyStore::*column, T BodyState::*field) {
+        return m_store ? (m_store->*column)[m_row] : m_state.*field;
+    }
+    template <typename T>
+    [[nodiscard]] const T &state(std::vector<T> BodyStore::*column, T BodyState::*field) const {
+        return m_store ? (m_store->*column)[m_row] : m_state.*field;
+    }
+
+    // the solver wakes whatever sleeps against a body moved outside its step, see Solver::wakeDisturbed
+    void markMoved() {
+        if (m_store)
+            m_store->is_moved[m_row] = 1;
+    }
 
     virtual void linearTransform(Vec2 dx) = 0;
     virtual void angularTransform(float d_angle) = 0;
 
+    // mass and inertia of the shape as if it were dynamic
+    [[nodiscard]] virtual float computeMass() const = 0;
+    [[nodiscard]] virtual float computeInertia() const = 0;
+
+    // every concrete body calls this once its shape is known
+    void updateMass() {
+        if (m_is_static) {
+            m_mass = std::numeric_limits<float>::infinity();
+            m_inverse_mass = 0.f;
+            m_inertia = std::numeric_limits<float>::infinity();
+            m_inverse_inertia = 0.f;
+        }
+        else {
+            m_mass = computeMass();
+            m_inverse_mass = 1.f / m_mass;
+            m_inertia = computeInertia();
+            m_inverse_inertia = m_inertia > 0.f ? 1.f / m_inertia : 0.f;
+        }
+        state(&BodyStore::inverse_mass, &BodyState::inverse_mass) = m_inverse_mass;
+    }
+
+    // kept up to date by linearTransform/angularTransform
+    void setAABB(const AABB &box) {
+        state(&BodyStore::min_x, &BodyState::min_x) = box.min.x;
+        state(&BodyStore::min_y, &BodyState::min_y) = box.min.y;
+        state(&BodyStore::max_x, &BodyState::max_x) = box.max.x;
+        state(&BodyStore::max_y, &BodyState::max_y) = box.max.y;
+    }
+    void shiftAABB(Vec2 dx) {
+        state(&BodyStore::min_x, &BodyState::min_x) += dx.x;
+        state(&BodyStore::min_y, &BodyState::min_y) += dx.y;
+        state(&BodyStore::max_x, &BodyState::max_x) += dx.x;
+        state(&BodyStore::max_y, &BodyState::max_y) += dx.y;
+    }
+
  public:
     Body(Vec2 position, Material material, ShapeType shape)
-        : m_position{position}, m_material{material}, m_shape{shape} {}
+        : m_material{material}, m_shape{shape} {
+        m_state.position_x = position.x;
+        m_state.position_y = position.y;
+        m_state.shape = shape;
+        setAABB({position, position});
+    }
+    Body(const Body &) = delete;
+    Body &operator=(const Body &) = delete;
+    virtual ~Body() {
+        if (m_store)
+            m_store->remove(m_handle);
+    }
 
-    virtual void update(float dt) {
-        accelerate(m_force / mass());
-        addVelocity(m_acceleration * dt);
-        move(m_velocity * dt);
+    // single body version of BodyStore::integrate
+    void update(float dt) {
+        accelerate(force() * m_inverse_mass);
+        addVelocity(acceleration() * dt);
+        move(velocity() * dt);
 
 //        addAngularAcceleration(torque);
-        addAngularVelocity(m_angular_acceleration * dt);
-        rotate(m_angular_velocity * dt);
+        addAngularVelocity(angularAcceleration() * dt);
+        rotate(angularVelocity() * dt);
 
         setAcceleration({});
         setForce({});
     }
     virtual List<sf::Drawable *> render() = 0;
 
-    [[nodiscard]] virtual float mass() const {
-        if (m_is_static)
-            return std::numeric_limits<float>::infinity();
-        else
-            return 0;
+    [[nodiscard]] float mass() const {
+        return m_mass;
+    }
+    [[nodiscard]] float inverseMass() const {
+        return m_inverse_mass;
+    }
+    [[nodiscard]] float inertia() const {
+        return m_inertia;
+    }
+    [[nodiscard]] float inverseInertia() const {
+        return m_inverse_inertia;
     }
-    [[nodiscard]] virtual float inertia() const = 0;
 
     Body& addForce(Vec2 force) {
-        m_force += force;
-        return *this;
+        return setForce(this->force() + force);
     }
     Body& setForce(Vec2 force) {
-        m_force = force;
+        state(&BodyStore::force_x, &BodyState::force_x) = force.x;
+        state(&BodyStore::force_y, &BodyState::force_y) = force.y;
         return *this;
     }
     [[nodiscard]] Vec2 force() const {
-        return m_force;
+        return {state(&BodyStore::force_x, &BodyState::force_x), state(&BodyStore::force_y, &BodyState::force_y)};
     }
 
     Body& addPosition(Vec2 movement) {
-        m_position += movement;
+        state(&BodyStore::position_x, &BodyState::position_x) += movement.x;
+        state(&BodyStore::position_y, &BodyState::position_y) += movement.y;
         linearTransform(movement);
+        if (movement != Vec2{})
+            markMoved();
         return *this;
     }
     Body& setPosition(Vec2 position) {
-        return addPosition(position - m_position);
+        return addPosition(position - this->position());
     }
     [[nodiscard]] Vec2 position() const {
-        return m_position;
+        return {state(&BodyStore::position_x, &BodyState::position_x),
+                state(&BodyStore::position_y, &BodyState::position_y)};
     }
 
     Body& addVelocity(Vec2 velocity) {
-        Vec2 new_velocity = m_velocity + velocity;
-        if (std::abs(new_velocity) <= m_max_speed)
-            m_velocity = new_velocity;
+        Vec2 new_velocity = this->velocity() + velocity;
+        if (std::abs(new_velocity) <= maxSpeed()) {
+            state(&BodyStore::velocity_x, &BodyState::velocity_x) = new_velocity.x;
+            state(&BodyStore::velocity_y, &BodyState::velocity_y) = new_velocity.y;
+        }
 
         return *this;
     }
     Body& setVelocity(Vec2 velocity) {
-        if (std::abs(velocity) <= m_max_speed)
-            m_velocity = velocity;
-        else
-            m_velocity = Math::normalize(velocity) * m_max_speed;
+        if (std::abs(velocity) > maxSpeed())
+            velocity = Math::normalize(velocity) * maxSpeed();
 
+        state(&BodyStore::velocity_x, &BodyState::velocity_x) = velocity.x;
+        state(&BodyStore::velocity_y, &BodyState::velocity_y) = velocity.y;
         return *this;
     }
     [[nodiscard]] Vec2 velocity() const {
-        return m_velocity;
+        return {state(&BodyStore::velocity_x, &BodyState::velocity_x),
+                state(&BodyStore::velocity_y, &BodyState::velocity_y)};
     }
 
     Body& addAcceleration(Vec2 acceleration) {
-        m_acceleration += acceleration;
-        return *this;
+        return setAcceleration(this->acceleration() + acceleration);
     }
     Body& setAcceleration(Vec2 acceleration) {
-        m_acceleration = acceleration;
+        state(&BodyStore::acceleration_x, &BodyState::acceleration_x) = acceleration.x;
+        state(&BodyStore::acceleration_y, &BodyState::acceleration_y) = acceleration.y;
         return *this;
     }
     [[nodiscard]] Vec2 acceleration() const {
-        return m_acceleration;
+        return {state(&BodyStore::acceleration_x, &BodyState::acceleration_x),
+                state(&BodyStore::acceleration_y, &BodyState::acceleration_y)};
     }
 
     Body& addAngle(float angle) {
-        m_angle += angle;
+        state(&BodyStore::angle, &BodyState::angle) += angle;
         angularTransform(angle);
+        if (angle != 0.f)
+            markMoved();
         return *this;
     }
     Body& setAngle(float angle) {
-        return addAngle(angle - m_angle);
+        return addAngle(angle - this->angle());
     }
     [[nodiscard]] float angle() const {
-        return m_angle;
+        return state(&BodyStore::angle, &BodyState::angle);
     }
 
     Body& addAngularVelocity(float angular_velocity) {
-        float new_angle_velocity = m_angular_velocity + angular_velocity;
-        if (std::abs(new_angle_velocity) <= m_max_angular_speed)
-            m_angular_velocity = new_angle_velocity;
+        float new_angle_velocity = angularVelocity() + angular_velocity;
+        if (std::abs(new_angle_velocity) <= maxAngularSpeed())
+            state(&BodyStore::angular_velocity, &BodyState::angular_velocity) = new_angle_velocity;
 
         return *this;
     }
     Body& setAngularVelocity(float angular_velocity) {
-        m_angular_velocity = std::min(angular_velocity, m_max_angular_speed);
+        state(&BodyStore::angular_velocity, &BodyState::angular_velocity)
+            = std::min(angular_velocity, maxAngularSpeed());
         return *this;
     }
     [[nodiscard]] float angularVelocity() const {
-        return m_angular_velocity;
+        return state(&BodyStore::angular_velocity, &BodyState::angular_velocity);
     }
 
     Body& addAngularAcceleration(float angular_acceleration) {
-        m_angular_acceleration += angular_acceleration;
-        return *this;
+        return setAngularAcceleration(angularAcceleration() + angular_acceleration);
     }
     Body& setAngularAcceleration(float angular_acceleration) {
-        m_angular_acceleration = angular_acceleration;
+        state(&BodyStore::angular_acceleration, &BodyState::angular_acceleration) = angular_acceleration;
         return *this;
     }
     [[nodiscard]] float angularAcceleration() const {
-        return m_angular_acceleration;
+        return state(&BodyStore::angular_acceleration, &BodyState::angular_acceleration);
     }
 
     [[nodiscard]] Material material() const {
@@ -162,6 +245,15 @@ class Body {
         return m_shape;
     }
 
+    [[nodiscard]] AABB aabb() const {
+        return {{state(&BodyStore::min_x, &BodyState::min_x), state(&BodyStore::min_y, &BodyState::min_y)},
+                {state(&BodyStore::max_x, &BodyState::max_x), state(&BodyStore::max_y, &BodyState::max_y)}};
+    }
+
+    [[nodiscard]] BodyHandle handle() const {
+        return m_handle;
+    }
+
     Body& setColor(sf::Color color) {
         m_color = color;
         m_outline_color = whiteOrBlack(color);
@@ -181,26 +273,41 @@ class Body {
 
     Body& setStatic(bool is_static) {
         m_is_static = is_static;
+        state(&BodyStore::is_static, &BodyState::is_static) = is_static;
+        updateMass();
         return *this;
     }
     [[nodiscard]] bool isStatic() const {
         return m_is_static;
     }
+    // false while the solver keeps the body asleep, see Solver::setSleeping
+    [[nodiscard]] bool isAwake() const {
+        return state(&BodyStore::is_awake, &BodyState::is_awake) != 0;
+    }
+
+    // a bullet is stopped at whatever it would pass through within a substep, see Solver::setBulletSpeed
+    Body& setBullet(bool is_bullet) {
+        state(&BodyStore::is_bullet, &BodyState::is_bullet) = is_bullet;
+        return *this;
+    }
+    [[nodiscard]] bool isBullet() const {
+        return state(&BodyStore::is_bullet, &BodyState::is_bullet) != 0;
+    }
 
     Body& setMaxSpeed(float speed) {
-        m_max_speed = speed;
+        state(&BodyStore::max_speed, &BodyState::max_speed) = speed;
         return *this;
     }
     [[nodiscard]] float maxSpeed() const {
-        return m_max_speed;
+        return state(&BodyStore::max_speed, &BodyState::max_speed);
     }
 
     Body& setMaxAngularSpeed(float angular_speed) {
-        m_max_angular_speed = angular_speed;
+        state(&BodyStore::max_angular_speed, &BodyState::max_angular_speed) = angular_speed;
         return *this;
     }
     [[nodiscard]] float maxAngularSpeed() const {
-        return m_max_angular_speed;
+        return state(&BodyStore::max_angular_speed, &BodyState::max_angular_speed);
     }
 
     // friendly functions
@@ -227,13 +334,7 @@ class Body {
 
     // etc
     [[nodiscard]] float speed() const {
-        return std::abs(m_velocity);
-    }
-    [[nodiscard]] float inverseMass() const {
-        if (m_is_static)
-            return 0;
-        else
-            return 1.f / mass();
+        return std::abs(velocity());
     }
 };
 
@@ -241,11 +342,17 @@ class CircleBody : public Body {
  protected:
     const float m_radius;
 
-    void linearTransform(Vec2 dx) override {};
+    void linearTransform(Vec2 dx) override {
+        shiftAABB(dx);
+    };
     void angularTransform(float d_angle) override {};
  public:
     CircleBody(Vec2 position, float radius, Material material)
-        : Body{position, material, ShapeType::CIRCLE}, m_radius{radius} {}
+        : Body{position, material, ShapeType::CIRCLE}, m_radius{radius} {
+        state(&BodyStore::radius, &BodyState::radius) = radius;
+        setAABB({position - Vec2{radius, radius}, position + Vec2{radius, radius}});
+        updateMass();
+    }
 
     [[nodiscard]] bool isConvex() const override {
         return true;
@@ -258,11 +365,11 @@ class CircleBody : public Body {
         return m_radius;
     }
 
-    [[nodiscard]] float mass() const override {
-        return std::max(Body::mass(), m_material.density * std::numbers::pi_v<float> * (m_radius * m_radius));
+    [[nodiscard]] float computeMass() const override {
+        return m_material.density * std::numbers::pi_v<float> * (m_radius * m_radius);
     }
-    [[nodiscard]] float inertia() const override {
-        return 0.5f * mass() * m_radius * m_radius;
+    [[nodiscard]] float computeInertia() const override {
+        return 0.5f * computeMass() * m_radius * m_radius;
     }
 
     List<sf::Drawable *> render() override {
@@ -288,25 +395,106 @@ class CircleBody : public Body {
 
 class PolygonBody : public Body {
  protected:
-    List<Vec2> m_vertices;
+    List<Vec2> m_local_vertices;            // relative to the position, at angle 0
+    List<Vec2> m_local_normals;             // unit normal of the edge (i, i + 1), at angle 0
+    mutable List<Vec2> m_vertices;          // world space, derived lazily from m_local_vertices
+    mutable List<Vec2> m_normals;           // world space, only depend on the rotation
+    mutable Vec2 m_rotation{1.f, 0.f};      // (cos, sin) of the angle
+    // pose the world vertices and normals were built for. the state can change behind the body's back
+    // (BodyStore::integrate writes the rows directly), so staleness is detected by comparing poses.
+    mutable Vec2 m_synced_position{std::numeric_limits<float>::quiet_NaN(), 0.f};
+    mutable float m_synced_angle = std::numeric_limits<float>::quiet_NaN();
 
     void linearTransform(Vec2 dx) override {
-        for (auto &vertex : m_vertices) {
-            vertex += dx;
-        }
+        shiftAABB(dx);
     };
     void angularTransform(float d_angle) override {
-        for (auto &vertex : m_vertices) {
-            vertex = Math::rotate(vertex, d_angle, m_position);
-        }
+        if (d_angle == 0.f)
+            return;
+
+        updateAABB();
     };
+
+    void setLocalVertices(List<Vec2> vertices) {
+        m_local_vertices = std::move(vertices);
+        updateNormals();
+        updateAABB();
+    }
+
+    void updateNormals() {
+        // outward whichever way the vertices wind
+        float area = 0.f;
+        for (size_t i = 0; i < m_local_vertices.size(); ++i)
+            area += Math::cross(m_local_vertices[i], m_local_vertices[(i + 1) % m_local_vertices.size()]);
+        const float outward = area < 0.f ? -1.f : 1.f;
+
+        m_local_normals.resize(m_local_vertices.size());
+        for (size_t i = 0; i < m_local_vertices.size(); ++i) {
+            Vec2 edge = m_local_vertices[(i + 1) % m_local_vertices.size()] - m_local_vertices[i];
+            m_local_normals[i] = Math::normalize(Vec2{edge.y, -edge.x}) * outward;
+        }
+
+        m_synced_angle = std::numeric_limits<float>::quiet_NaN();
+    }
+
+    void updateAABB() {
+        syncTransform();
+        if (m_vertices.empty()) {
+            setAABB({position(), position()});
+            return;
+        }
+
+        AABB box{m_vertices[0], m_vertices[0]};
+        for (const auto &vertex : m_vertices) {
+            box.min = {std::min(box.min.x, vertex.x), std::min(box.min.y, vertex.y)};
+            box.max = {std::max(box.max.x, vertex.x), std::max(box.max.y, vertex.y)};
+        }
+        setAABB(box);
+    }
  public:
     PolygonBody(Vec2 position, List<Vec2> vertices, Material material)
-        : Body{position, material, ShapeType::POLYGON}, m_vertices{std::move(vertices)} {
+        : Body{position, material, ShapeType::POLYGON}, m_local_vertices{std::move(vertices)} {
+        for (auto &vertex : m_local_vertices)
+            vertex -= position;
+        updateNormals();
         setAngle(Math::PI / 2);
+        updateMass();
+    }
+
+    // rebuilds the world vertices from the local ones, at most once per change of position or angle.
+    // reading vertices() syncs lazily, which is not safe from several threads: sync first in that case
+    void syncTransform() const {
+        const Vec2 position = this->position();
+        const float angle = this->angle();
+        const bool rotated = angle != m_synced_angle;
+        if (!rotated && position == m_synced_position)
+            return;
+
+        if (rotated) {
+            m_rotation = {std::cos(angle), std::sin(angle)};
+
+            const float c = m_rotation.x, s = m_rotation.y;
+            m_normals.resize(m_local_normals.size());
+            for (size_t i = 0; i < m_local_normals.size(); ++i) {
+                const Vec2 &n = m_local_normals[i];
+                m_normals[i] = {n.x * c - n.y * s, n.x * s + n.y * c};
+            }
+
+            m_synced_angle = angle;
+        }
+
+        const float c = m_rotation.x, s = m_rotation.y;
+        m_vertices.resize(m_local_vertices.size());
+        for (size_t i = 0; i < m_local_vertices.size(); ++i) {
+            const Vec2 &v = m_local_vertices[i];
+            m_vertices[i] = {position.x + v.x * c - v.y * s, position.y + v.x * s + v.y * c};
+        }
+
+        m_synced_position = position;
     }
 
     [[nodiscard]] bool isConvex() const override {
+        syncTransform();
         for (int i = 0; i < m_vertices.size(); ++i) {
             Vec2 p1 = m_vertices[i];
             Vec2 p2 = m_vertices[(i + 1) % m_vertices.size()];
@@ -320,6 +508,7 @@ class PolygonBody : public Body {
     }
     bool contains(Vec2 point) override {
         // https://anz1217.tistory.com/107
+        syncTransform();
         if (isConcave()) {
             int count = 0;
             for (int i = 0; i < m_vertices.size(); ++i) {
@@ -374,37 +563,47 @@ class PolygonBody : public Body {
         }
     }
 
-    [[nodiscard]] List<Vec2> vertices() const {
+    [[nodiscard]] const List<Vec2> &vertices() const {
+        syncTransform();
         return m_vertices;
     }
     [[nodiscard]] Vec2 vertex(int index) const {
-        return m_vertices[index];
+        return vertices()[index];
+    }
+    [[nodiscard]] const List<Vec2> &normals() const {
+        syncTransform();
+        return m_normals;
+    }
+    [[nodiscard]] const List<Vec2> &localVertices() const {
+        return m_local_vertices;
     }
     [[nodiscard]] uint64_t sides() const {
-        return m_vertices.size();
+        return m_local_vertices.size();
     }
 
-    [[nodiscard]] float mass() const override {
+    [[nodiscard]] float computeMass() const override {
+        // signed, negative for clockwise vertices
         float area = 0;
-        for (int i = 0; i < m_vertices.size(); ++i) {
-            Vec2 p1 = m_vertices[i];
-            Vec2 p2 = m_vertices[(i + 1) % m_vertices.size()];
-            area += Math::cross(p1 - position(), p2 - position()) / 2.f;
+        for (size_t i = 0; i < m_local_vertices.size(); ++i) {
+            Vec2 p1 = m_local_vertices[i];
+            Vec2 p2 = m_local_vertices[(i + 1) % m_local_vertices.size()];
+            area += Math::cross(p1, p2) / 2.f;
         }
 
-        return std::max(Body::mass(), material().density * area);
+        return material().density * std::abs(area);
     }
-    [[nodiscard]] float inertia() const override {
+    [[nodiscard]] float computeInertia() const override {
+        // second moment of area about the position, summed over the triangles (position, p1, p2)
         float inertia = 0;
-        for (int i = 0; i < m_vertices.size(); ++i) {
-            Vec2 p1 = m_vertices[i];
-            Vec2 p2 = m_vertices[(i + 1) % m_vertices.size()];
+        for (size_t i = 0; i < m_local_vertices.size(); ++i) {
+            Vec2 p1 = m_local_vertices[i];
+            Vec2 p2 = m_local_vertices[(i + 1) % m_local_vertices.size()];
             inertia += Math::cross(p1, p2) * (Math::dot(p1, p1) + Math::dot(p1, p2) + Math::dot(p2, p2));
         }
 
-        // TODO: 정확하지 않음
-        return mass() * inertia / 6.f;
-    };
+        // the same sign as the area
+        return material().density * std::abs(inertia) / 12.f;
+    }
 
     List<sf::Drawable *> render() override {
         auto *poly = new sf::ConvexShape(sides());
@@ -412,6 +611,7 @@ class PolygonBody : public Body {
         poly->setOutlineThickness(2.f);
         poly->setOutlineColor(outlineColor());
 
+        syncTransform();
         for (int i = 0; i < m_vertices.size(); ++i) {
             auto n = Math::normalize(m_vertices[i] - position());
             poly->setPoint(i, m_vertices[i] - n * 2.f);
@@ -427,15 +627,18 @@ class RectangleBody : public PolygonBody {
  public:
     RectangleBody(Vec2 position, float width, float height, Material material)
         : PolygonBody{position, {}, material}, m_width{width}, m_height{height} {
-        const sf::Vector2f h = heightVec();
-        const sf::Vector2f w = widthVec();
-        m_vertices = {position - h + w, position + h + w, position + h - w, position - h - w};  // 반시계방향
+        // local vertices at angle 0, the body itself starts rotated by PolygonBody
+        const sf::Vector2f h{m_height / 2, 0.f};
+        const sf::Vector2f w{0.f, m_width / 2};
+        setLocalVertices({-h + w, h + w, h - w, -h - w});  // 반시계방향
+        updateMass();
     }
 
     [[nodiscard]] bool isConvex() const override {
         return true;
     }
     bool contains(Vec2 point) override {
+        syncTransform();
         Vec2 p1 = m_vertices[0];
         Vec2 p2 = m_vertices[1];
         Vec2 p3 = m_vertices[2];
@@ -457,17 +660,17 @@ class RectangleBody : public PolygonBody {
     }
 
     [[nodiscard]] sf::Vector2f heightVec() const {  // 박스 중심에서 윗 변 중심으로의 벡터
-        return sf::Vector2f{std::cos(m_angle), std::sin(m_angle)} * (m_height / 2);
+        return sf::Vector2f{std::cos(angle()), std::sin(angle())} * (m_height / 2);
     }
     [[nodiscard]] sf::Vector2f widthVec() const {   // 박스 중심에서 왼쪽 변 중심으로의 벡터
-        return sf::Vector2f{-std::sin(m_angle), std::cos(m_angle)} * (m_width / 2);
+        return sf::Vector2f{-std::sin(angle()), std::cos(angle())} * (m_width / 2);
     }
 
-    [[nodiscard]] float mass() const override {
-        return std::max(Body::mass(), m_material.density * m_width * m_height);
+    [[nodiscard]] float computeMass() const override {
+        return m_material.density * m_width * m_height;
     }
-    [[nodiscard]] float inertia() const override {
-        return mass() * (m_width * m_width + m_height * m_height) / 12.f;
+    [[nodiscard]] float computeInertia() const override {
+        return computeMass() * (m_width * m_width + m_height * m_height) / 12.f;
     }
 };
 
@@ -480,10 +683,14 @@ class RegularPolygonBody : public PolygonBody {
         if (sides < 3)
             throw std::invalid_argument("RegularPolygonBody: sides must be >= 3");
 
+        // (sin, -cos) undoes the quarter turn PolygonBody starts with
+        List<Vec2> vertices;
         for (uint64_t i = 0; i < sides; ++i) {
             float angle = 2.f * Math::PI * (float)i / sides;
-            m_vertices.emplace_back(position + radius * Vec2{std::cos(angle), std::sin(angle)});
+            vertices.emplace_back(radius * Vec2{std::sin(angle), -std::cos(angle)});
         }
+        setLocalVertices(std::move(vertices));
+        updateMass();
     }
 
     [[nodiscard]] bool isConvex() const override {
@@ -497,13 +704,187 @@ class RegularPolygonBody : public PolygonBody {
         return 2.f * m_radius * std::sin(Math::PI / sides());
     }
 
-    [[nodiscard]] float mass() const override {
-        return std::max(Body::mass(), m_material.density * m_radius * m_radius * sides() * std::sin(Math::PI / sides()));
+    [[nodiscard]] float computeMass() const override {
+        return m_material.density * m_radius * m_radius * sides() * std::sin(Math::PI / sides());
     }
-    [[nodiscard]] float inertia() const override {
+    [[nodiscard]] float computeInertia() const override {
         // ref: https://m.blog.naver.com/PostView.naver?blogId=gks36247&logNo=221548621791&fromRecommendationType=category&targetRecommendationDetailCode=1000
         float tan = std::tan(Math::PI / sides());
         float beta = 1.f/8 * (1.f/3 + 1.f/(tan*tan));
-        return beta * mass() * length() * length();
+        return beta * computeMass() * length() * length();
     }
-};
\ No newline at end of file
+};
+
+inline BodyHandle BodyStore::add(Body* body) {
+    uint32_t id;
+    if (free_ids.empty()) {
+        id = static_cast<uint32_t>(row_of.size());
+        row_of.push_back(BodyHandle::NONE);
+        generation_of.push_back(0);
+    }
+    else {
+        id = free_ids.back();
+        free_ids.pop_back();
+    }
+
+    const uint32_t row = size();
+    forEachColumn([](auto &column) { column.emplace_back(); });
+    max_speed[row] = std::numeric_limits<float>::infinity();
+    max_angular_speed[row] = std::numeric_limits<float>::infinity();
+    is_awake[row] = 1;
+    island[row] = BodyHandle::NONE;
+    bodies[row] = body;
+    id_of[row] = id;
+    row_of[id] = row;
+
+    body->m_store = this;
+    body->m_handle = {id, generation_of[id]};
+    body->m_row = row;
+    return body->m_handle;
+}
+
+inline void BodyStore::remove(BodyHandle handle) {
+    const uint32_t row = row_of[handle.id];
+    const uint32_t last = size() - 1;
+
+    if (row != last) {
+        forEachColumn([row, last](auto &column) { column[row] = column[last]; });
+        row_of[id_of[row]] = row;
+        bodies[row]->m_row = row;
+    }
+    forEachColumn([](auto &column) { column.pop_back(); });
+
+    row_of[handle.id] = BodyHandle::NONE;
+    generation_of[handle.id]++;
+    free_ids.push_back(handle.id);
+}
+
+inline BodyState BodyStore::state(uint32_t row) const {
+    BodyState state;
+    auto copy = [&](auto column, auto field) { state.*field = (this->*column)[row]; };
+    copy(&BodyStore::position_x, &BodyState::position_x); copy(&BodyStore::position_y, &BodyState::position_y);
+    copy(&BodyStore::velocity_x, &BodyState::velocity_x); copy(&BodyStore::velocity_y, &BodyState::velocity_y);
+    copy(&BodyStore::acceleration_x, &BodyState::acceleration_x);
+    copy(&BodyStore::acceleration_y, &BodyState::acceleration_y);
+    copy(&BodyStore::force_x, &BodyState::force_x); copy(&BodyStore::force_y, &BodyState::force_y);
+    copy(&BodyStore::angle, &BodyState::angle);
+    copy(&BodyStore::angular_velocity, &BodyState::angular_velocity);
+    copy(&BodyStore::angular_acceleration, &BodyState::angular_acceleration);
+    copy(&BodyStore::max_speed, &BodyState::max_speed);
+    copy(&BodyStore::max_angular_speed, &BodyState::max_angular_speed);
+    copy(&BodyStore::inverse_mass, &BodyState::inverse_mass);
+    copy(&BodyStore::min_x, &BodyState::min_x); copy(&BodyStore::min_y, &BodyState::min_y);
+    copy(&BodyStore::max_x, &BodyState::max_x); copy(&BodyStore::max_y, &BodyState::max_y);
+    copy(&BodyStore::is_static, &BodyState::is_static); copy(&BodyStore::is_bullet, &BodyState::is_bullet);
+    copy(&BodyStore::is_awake, &BodyState::is_awake); copy(&BodyStore::sleep_time, &BodyState::sleep_time);
+    copy(&BodyStore::island, &BodyState::island);
+    copy(&BodyStore::shape, &BodyState::shape); copy(&BodyStore::radius, &BodyState::radius);
+    return state;
+}
+
+inline void BodyStore::setState(uint32_t row, const BodyState &state) {
+    auto copy = [&](auto column, auto field) { (this->*column)[row] = state.*field; };
+    copy(&BodyStore::position_x, &BodyState::position_x); copy(&BodyStore::position_y, &BodyState::position_y);
+    copy(&BodyStore::velocity_x, &BodyState::velocity_x); copy(&BodyStore::velocity_y, &BodyState::velocity_y);
+    copy(&BodyStore::acceleration_x, &BodyState::acceleration_x);
+    copy(&BodyStore::acceleration_y, &BodyState::acceleration_y);
+    copy(&BodyStore::force_x, &BodyState::force_x); copy(&BodyStore::force_y, &BodyState::force_y);
+    copy(&BodyStore::angle, &BodyState::angle);
+    copy(&BodyStore::angular_velocity, &BodyState::angular_velocity);
+    copy(&BodyStore::angular_acceleration, &BodyState::angular_acceleration);
+    copy(&BodyStore::max_speed, &BodyState::max_speed);
+    copy(&BodyStore::max_angular_speed, &BodyState::max_angular_speed);
+    copy(&BodyStore::inverse_mass, &BodyState::inverse_mass);
+    copy(&BodyStore::min_x, &BodyState::min_x); copy(&BodyStore::min_y, &BodyState::min_y);
+    copy(&BodyStore::max_x, &BodyState::max_x); copy(&BodyStore::max_y, &BodyState::max_y);
+    copy(&BodyStore::is_static, &BodyState::is_static); copy(&BodyStore::is_bullet, &BodyState::is_bullet);
+    copy(&BodyStore::is_awake, &BodyState::is_awake); copy(&BodyStore::sleep_time, &BodyState::sleep_time);
+    copy(&BodyStore::island, &BodyState::island);
+    copy(&BodyStore::shape, &BodyState::shape); copy(&BodyStore::radius, &BodyState::radius);
+}
+
+inline void BodyStore::adopt(Body* body) {
+    BodyStore* from = body->m_store;
+    if (from == this)
+        return;
+
+    const BodyState state = from ? from->state(body->m_row) : body->m_state;
+    if (from)
+        from->remove(body->m_handle);
+
+    add(body);
+    setState(body->m_row, state);
+}
+
+inline void BodyStore::detach(Body* body) {
+    body->m_state = state(body->m_row);
+    remove(body->m_handle);
+    body->m_store = nullptr;
+    body->m_handle = {};
+    body->m_row = 0;
+}
+
+inline void BodyStore::integrateVelocity(float dt, uint32_t begin, uint32_t end) {
+    // the columns never alias, telling the compiler so lets it vectorize the loop
+    float* __restrict vx = velocity_x.data();
+    float* __restrict vy = velocity_y.data();
+    float* __restrict ax = acceleration_x.data();
+    float* __restrict ay = acceleration_y.data();
+    float* __restrict fx = force_x.data();
+    float* __restrict fy = force_y.data();
+    const float* __restrict inv_m = inverse_mass.data();
+    const float* __restrict v_max = max_speed.data();
+
+    for (uint32_t i = begin; i < end; ++i) {
+        const float acc_x = ax[i] + fx[i] * inv_m[i];
+        const float acc_y = ay[i] + fy[i] * inv_m[i];
+
+        // a velocity change that would exceed the max speed is dropped, as in Body::addVelocity
+        const float new_vx = vx[i] + acc_x * dt;
+        const float new_vy = vy[i] + acc_y * dt;
+        const bool accept = new_vx * new_vx + new_vy * new_vy <= v_max[i] * v_max[i];
+        vx[i] = accept ? new_vx : vx[i];
+        vy[i] = accept ? new_vy : vy[i];
+
+        ax[i] = 0.f;
+        ay[i] = 0.f;
+        fx[i] = 0.f;
+        fy[i] = 0.f;
+    }
+
+    for (uint32_t i = begin; i < end; ++i) {
+        const float w = angular_velocity[i] + angular_acceleration[i] * dt;
+        angular_velocity[i] = std::abs(w) <= max_angular_speed[i] ? w : angular_velocity[i];
+    }
+}
+
+inline void BodyStore::integratePosition(float dt, uint32_t begin, uint32_t end) {
+    float* __restrict px = position_x.data();
+    float* __restrict py = position_y.data();
+    float* __restrict x0 = min_x.data();
+    float* __restrict y0 = min_y.data();
+    float* __restrict x1 = max_x.data();
+    float* __restrict y1 = max_y.data();
+    const float* __restrict vx = velocity_x.data();
+    const float* __restrict vy = velocity_y.data();
+
+    for (uint32_t i = begin; i < end; ++i) {
+        const float dx = vx[i] * dt;
+        const float dy = vy[i] * dt;
+        px[i] += dx;
+        py[i] += dy;
+        x0[i] += dx;
+        y0[i] += dy;
+        x1[i] += dx;
+        y1[i] += dy;
+    }
+
+    for (uint32_t i = begin; i < end; ++i)
+        angle[i] += angular_velocity[i] * dt;
+
+    // only a rotation can change the shape of an aabb
+    for (uint32_t i = begin; i < end; ++i) {
+        if (angular_velocity[i] != 0.f)
+            bodies[i]->angularTransform(angular_velocity[i] * dt);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// slab allocator for one body type. slots are carved out of slabs that are never moved or freed while the
+// pool lives, so a body keeps its address for its whole life and a destroyed body's slot is the next one
+// handed out. the pool does not know which slots are in use: whoever creates bodies destroys them.
+template <typename T>
+class BodyPool {
+ public:
+    static constexpr uint32_t SLAB_SIZE = 256;      // bodies per slab
+
+ private:
+    struct Slot {
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    std::vector<Slot*> free_slots;
+    uint32_t live = 0;
+
+    void grow() {
+        slabs.push_back(std::make_unique<Slot[]>(SLAB_SIZE));
+        // handed out in address order
+        Slot* slab = slabs.back().get();
+        for (uint32_t n = SLAB_SIZE; n--;)
+            free_slots.push_back(slab + n);
+    }
+
+ public:
+    BodyPool() = default;
+    BodyPool(const BodyPool &) = delete;
+    BodyPool &operator=(const BodyPool &) = delete;
+
+    template <typename... Args>
+    T* create(Args &&...args) {
+        if (free_slots.empty())
+            grow();
+
+        Slot* slot = free_slots.back();
+        free_slots.pop_back();
+        T* body;
+        try {
+            body = new (slot->storage) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            free_slots.push_back(slot);
+            throw;
+        }
+        live++;
+        return body;
+    }
+
+    // body must have come from create of this pool
+    void destroy(T* body) {
+        body->~T();
+        free_slots.push_back(reinterpret_cast<Slot*>(body));
+        live--;
+    }
+
+    // slabs for at least count bodies, so creating that many does not allocate them on the way
+    void reserve(uint32_t count) {
+        while (capacity() < count)
+            grow();
+    }
+
+    [[nodiscard]] uint32_t size() const {
+        return live;
+    }
+
+    [[nodiscard]] uint32_t capacity() const {
+        return static_cast<uint32_t>(slabs.size()) * SLAB_SIZE;
+    }
+};
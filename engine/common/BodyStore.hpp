@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+class Body;
+
+// an id is reused once its body is gone, the generation tells the new body from the old one
+struct BodyHandle {
+    static constexpr uint32_t NONE = 0xffffffff;
+
+    uint32_t id = NONE;
+    uint32_t generation = 0;
+
+    bool operator==(const BodyHandle &other) const = default;
+};
+
+// one row of a BodyStore, kept by the body itself while it is in no store
+struct BodyState {
+    float position_x = 0.f, position_y = 0.f;
+    float velocity_x = 0.f, velocity_y = 0.f;
+    float acceleration_x = 0.f, acceleration_y = 0.f;
+    float force_x = 0.f, force_y = 0.f;
+    float angle = 0.f, angular_velocity = 0.f, angular_acceleration = 0.f;
+    float max_speed = std::numeric_limits<float>::infinity();
+    float max_angular_speed = std::numeric_limits<float>::infinity();
+    float inverse_mass = 0.f;
+    float min_x = 0.f, min_y = 0.f, max_x = 0.f, max_y = 0.f;
+    uint8_t is_static = 0;
+    uint8_t is_bullet = 0;
+    uint8_t is_awake = 1;
+    float sleep_time = 0.f;
+    uint32_t island = BodyHandle::NONE;
+    uint8_t shape = 0;
+    float radius = 0.f;
+};
+
+// structure of arrays holding the state that integration and broadphase walk every substep.
+// rows are kept dense with swap-and-pop, so a row index changes on removal but a handle does not.
+class BodyStore {
+ public:
+    std::vector<float> position_x, position_y;
+    std::vector<float> velocity_x, velocity_y;
+    std::vector<float> acceleration_x, acceleration_y;
+    std::vector<float> force_x, force_y;
+    std::vector<float> angle, angular_velocity, angular_acceleration;
+    std::vector<float> max_speed, max_angular_speed;
+    std::vector<float> inverse_mass;
+    std::vector<float> min_x, min_y, max_x, max_y;   // aabb
+    std::vector<uint8_t> is_static;
+    std::vector<uint8_t> is_bullet;     // swept for impacts every substep, see Solver::setBulletSpeed
+    std::vector<uint8_t> is_awake;
+    std::vector<float> sleep_time;      // how long the body has been nearly at rest
+    std::vector<uint32_t> island;       // sleeping island of the owning solver, NONE while awake
+    std::vector<uint8_t> is_moved;      // moved by hand since the owning solver's last substep
+    std::vector<uint8_t> shape;         // ShapeType
+    std::vector<float> radius;          // circle radius, 0 for other shapes
+    std::vector<Body*> bodies;
+
+ private:
+    std::vector<uint32_t> row_of;     // handle id -> row
+    std::vector<uint32_t> id_of;      // row -> handle id
+    std::vector<uint32_t> generation_of;    // handle id -> generation, bumped when the id is freed
+    std::vector<uint32_t> free_ids;
+
+    template <typename F>
+    void forEachColumn(F &&f) {
+        f(position_x); f(position_y);
+        f(velocity_x); f(velocity_y);
+        f(acceleration_x); f(acceleration_y);
+        f(force_x); f(force_y);
+        f(angle); f(angular_velocity); f(angular_acceleration);
+        f(max_speed); f(max_angular_speed);
+        f(inverse_mass);
+        f(min_x); f(min_y); f(max_x); f(max_y);
+        f(is_static); f(is_bullet);
+        f(is_awake); f(sleep_time); f(island); f(is_moved);
+        f(shape); f(radius);
+        f(bodies);
+        f(id_of);
+    }
+
+    [[nodiscard]] BodyState state(uint32_t row) const;
+    void setState(uint32_t row, const BodyState &state);
+
+ public:
+    BodyStore() = default;
+    BodyStore(const BodyStore &) = delete;
+    BodyStore &operator=(const BodyStore &) = delete;
+
+    // appends a zeroed row for body
+    BodyHandle add(Body* body);
+    // removes the row of handle, the last row moves into its place
+    void remove(BodyHandle handle);
+    // moves body, with its state, from the store it is in, or from the body itself, to this one
+    void adopt(Body* body);
+    // gives body its state back to keep on its own, and removes its row
+    void detach(Body* body);
+
+    [[nodiscard]] uint32_t row(BodyHandle handle) const {
+        return row_of[handle.id];
+    }
+
+    [[nodiscard]] bool contains(BodyHandle handle) const {
+        return handle.id < row_of.size() && row_of[handle.id] != BodyHandle::NONE
+            && generation_of[handle.id] == handle.generation;
+    }
+
+    [[nodiscard]] BodyHandle handle(uint32_t row) const {
+        return {id_of[row], generation_of[id_of[row]]};
+    }
+
+    [[nodiscard]] uint32_t size() const {
+        return static_cast<uint32_t>(bodies.size());
+    }
+
+    void reserve(size_t capacity) {
+        forEachColumn([capacity](auto &column) { column.reserve(capacity); });
+    }
+
+    // acceleration += gravity for every awake dynamic row in [begin, end)
+    void applyGravity(float gravity_x, float gravity_y, uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const float dynamic = is_static[i] || !is_awake[i] ? 0.f : 1.f;
+            acceleration_x[i] += gravity_x * dynamic;
+            acceleration_y[i] += gravity_y * dynamic;
+        }
+    }
+
+    void applyGravity(float gravity_x, float gravity_y) {
+        applyGravity(gravity_x, gravity_y, 0, size());
+    }
+
+    // Body::update for every row in [begin, end). rows are independent, so ranges can run concurrently
+    void integrate(float dt, uint32_t begin, uint32_t end) {
+        integrateVelocity(dt, begin, end);
+        integratePosition(dt, begin, end);
+    }
+
+    // the two halves of integrate, a solver corrects the velocities in between
+    void integrateVelocity(float dt, uint32_t begin, uint32_t end);
+    void integratePosition(float dt, uint32_t begin, uint32_t end);
+
+    void integrate(float dt) {
+        integrate(dt, 0, size());
+    }
+};
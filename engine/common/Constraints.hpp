@@ -1,15 +1,36 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <utility>
 #include "Body.hpp"
 #include "../../utils/math.hpp"
 #include "Renderable.hpp"
 
+// how the solver runs constraints, see Solver::setConstraintSolver
+enum ConstraintSolverType {
+    POSITION_PROJECTION,    // apply() before the positions integrate, the velocities never hear of it
+    XPBD                    // solve() on the integrated positions, the velocities follow the corrections
+};
+
 class Constraint : public Renderable {
  public:
     sf::Color color = sf::Color::White;
+    float compliance = 0.f;     // xpbd only, the inverse of the stiffness. 0 is rigid
 
     virtual void apply() = 0;
+
+    // one xpbd iteration over a substep of dt. constraints without one fall back to apply
+    virtual void solve([[maybe_unused]] float dt) {
+        apply();
+    }
+
+    // xpbd accumulates its lagrange multipliers over the iterations of one substep
+    virtual void resetMultipliers() {}
+
+    // the two bodies apply() may move. constraints that cannot tell keep the default and are applied serially
+    virtual std::pair<Body*, Body*> bodies() const {
+        return {nullptr, nullptr};
+    }
 };
 
 class Chain : public Constraint {
@@ -17,10 +38,14 @@ class Chain : public Constraint {
     Body* body_1;
     Body* body_2;
     float target_dist;
+    float lambda = 0.f;
 
     Chain(Body* body_1, Body* body_2): body_1{body_1}, body_2{body_2}, target_dist{Math::length(body_1->position() - body_2->position())} {}
 
     void apply() override {
+        if (body_1->isStatic() && body_2->isStatic())
+            return;
+
         Vec2 p1 = body_1->position();
         Vec2 p2 = body_2->position();
 
@@ -45,6 +70,41 @@ class Chain : public Constraint {
         }
     }
 
+    // the same rope, pulled in by the inverse masses: a heavier body gives way less. a rope only pulls, so the
+    // accumulated lambda stays at or below 0. a link gone slack still runs the update, which gives back what a
+    // compliant rope pulled in earlier iterations instead of keeping it for the next correction
+    void solve(float dt) override {
+        const float w1 = body_1->inverseMass(), w2 = body_2->inverseMass();
+        if (w1 + w2 == 0.f)
+            return;
+
+        const Vec2 d = body_1->position() - body_2->position();
+        const float dist = std::abs(d);
+        if (dist == 0.f)
+            return;
+
+        const float c = dist - target_dist;
+        const Vec2 n = d / dist;
+        const float alpha = compliance / (dt * dt);
+        const float clamped = std::min(lambda + (-c - alpha * lambda) / (w1 + w2 + alpha), 0.f);
+        const float delta_lambda = clamped - lambda;
+        lambda = clamped;
+        if (delta_lambda == 0.f)
+            return;
+        if (w1 > 0.f)
+            body_1->move(n * (w1 * delta_lambda));
+        if (w2 > 0.f)
+            body_2->move(-n * (w2 * delta_lambda));
+    }
+
+    void resetMultipliers() override {
+        lambda = 0.f;
+    }
+
+    std::pair<Body*, Body*> bodies() const override {
+        return {body_1, body_2};
+    }
+
     std::vector<sf::Drawable*> render() override {
         // 흰 선
         auto* line = new sf::VertexArray(sf::Lines, 2);
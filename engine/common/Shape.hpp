@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstdint>
+
 enum ShapeType {
     CIRCLE,
     POLYGON
 };
+
+// number of shape types, the size of each dimension of the collision dispatch table
+inline constexpr uint32_t SHAPE_TYPE_COUNT = POLYGON + 1;
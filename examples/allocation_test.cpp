@@ -0,0 +1,107 @@
+#include "../Particles.hpp"
+#include "allocation_counter.hpp"
+
+// a settled pyramid, polygons at rest and swinging chains, every broadphase with the optional features off and
+// on, on one thread and on several. sleeping is off there so the whole scene keeps going through every stage
+// of the step. in the sleeping configuration the pyramid and a polygon are knocked every second instead, so
+// their islands fall asleep and wake over and over. exits with 1 when any update after the warm-up allocated
+int main() {
+    const uint32_t warmup_frames = 600;
+    const uint32_t test_frames = 240;
+
+    const uint32_t knock_frames = 120;
+
+    const char* names[] = {"all pairs", "uniform grid", "sweep and prune", "aabb tree"};
+    const char* configurations[] = {"plain", "features", "sleeping"};
+
+    bool failed = false;
+    for (BroadphaseType broadphase : {ALL_PAIRS, UNIFORM_GRID, SWEEP_AND_PRUNE, AABB_TREE}) {
+        for (uint32_t configuration = 0; configuration < 3; ++configuration) {
+            const bool features = configuration == 1, sleeping = configuration == 2;
+            for (uint32_t threads : {1u, 4u}) {
+                Solver solver{{0.f, 1500.f}, 4, 120};
+                solver.setBroadphase(broadphase);
+                solver.setBroadphaseThreshold(0);
+                solver.setThreadCount(threads);
+                solver.setSleeping(sleeping);
+                if (features) {
+                    solver.setSpeculativeContacts(true);
+                    solver.setConstraintSolver(XPBD);
+                    solver.setConstraintIterations(8);
+                    solver.setNarrowphase(POLYGON, POLYGON, GJK_EPA);
+                    solver.setNarrowphase(CIRCLE, POLYGON, GJK_EPA);
+                }
+
+                // a pyramid of balls held in by walls at its base, one island large enough to be colored
+                const uint32_t base = 28;
+                const float radius = 8.f, floor_y = 800.f, left = 100.f;
+                const float right = left + 2.f * radius * static_cast<float>(base);
+                const std::pair<Vec2, Vec2> walls[] = {
+                    {{500.f, floor_y + 20.f}, {1000.f, 40.f}},
+                    {{left - 10.f, floor_y - 30.f}, {20.f, 60.f}},
+                    {{right + 10.f, floor_y - 30.f}, {20.f, 60.f}},
+                };
+                for (auto [center, size] : walls) {
+                    auto wall = new RectangleBody(center, size.x, size.y, Materials::wood);
+                    wall->setStatic(true);
+                    solver.addBody(wall);
+                }
+                Body* apex = nullptr;
+                for (uint32_t row = 0; row < base; ++row) {
+                    for (uint32_t n = 0; n + row < base; ++n) {
+                        const Vec2 position{left + radius * static_cast<float>(2 * n + row + 1),
+                                            floor_y - radius - 1.75f * radius * static_cast<float>(row)};
+                        auto ball = new CircleBody(position, radius, Materials::wood);
+                        ball->setBullet(features && n % 10 == 0);
+                        apex = &solver.addBody(ball);
+                    }
+                }
+
+                // polygons resting on the floor apart from each other
+                Body* polygon = nullptr;
+                for (uint32_t n = 0; n < 8; ++n) {
+                    const Vec2 position{right + 50.f + 30.f * static_cast<float>(n), floor_y - 12.f};
+                    polygon = &solver.addBody(new RegularPolygonBody(position, 12.f, 3 + n, Materials::wood));
+                }
+
+                // chains swinging high above everything else
+                for (uint32_t c = 0; c < 3; ++c) {
+                    Body* previous = &solver.addBody(new CircleBody({200.f + 300.f * c, 60.f}, 5.f, Materials::ideal));
+                    previous->setStatic(true);
+                    for (uint32_t k = 1; k <= 12; ++k) {
+                        Body* link = &solver.addBody(new CircleBody({200.f + 300.f * c + 11.f * k, 60.f}, 5.f, Materials::ideal));
+                        solver.addConstraint(new Chain(previous, link));
+                        previous = link;
+                    }
+                }
+
+                auto step = [&](uint32_t f) {
+                    if (sleeping && f % knock_frames == 0) {
+                        apex->setVelocity({0.f, -20.f});
+                        polygon->setVelocity({20.f, 0.f});
+                    }
+                    solver.update();
+                };
+
+                for (uint32_t f = 0; f < warmup_frames; ++f)
+                    step(f);
+
+                uint64_t most_asleep = 0;
+                const uint64_t before = allocations;
+                for (uint32_t f = 0; f < test_frames; ++f) {
+                    step(f);
+                    most_asleep = std::max(most_asleep, solver.getSleepingBodyCount());
+                }
+                const uint64_t made = allocations - before;
+
+                std::cout << std::format("{:<16} {:<9} {} threads: {} allocations, at most {} asleep", names[broadphase],
+                                         configurations[configuration], threads, made, most_asleep) << std::endl;
+                // a sleeping configuration where nothing fell asleep checked nothing
+                failed |= made > 0 || (sleeping && most_asleep == 0);
+            }
+        }
+    }
+
+    std::cout << (failed ? "FAILED" : "passed") << std::endl;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -18,6 +18,13 @@ int main() {
     evm.addEventCallback(sf::Event::Closed, [&window](sf::Event) { window.close(); });
     evm.addKeyPressedCallback(sf::Keyboard::Escape, [&window](sf::Event) { window.close(); });
     evm.addKeyPressedCallback(sf::Keyboard::Space, [&run](sf::Event) { run = !run; });
+    // xpbd keeps the chain at its length with far fewer substeps
+    evm.addKeyPressedCallback(sf::Keyboard::X, [&solver](sf::Event) {
+        const bool xpbd = solver.getConstraintSolver() == POSITION_PROJECTION;
+        solver.setConstraintSolver(xpbd ? XPBD : POSITION_PROJECTION);
+        solver.setSubSteps(xpbd ? 2 : 8);
+        solver.setConstraintIterations(xpbd ? 20 : 4);
+    });
 
     auto floor = new RectangleBody({window_size.x / 2, 3 * window_size.y / 4},
                                     700.f,70.f,Materials::ideal);
@@ -41,6 +48,9 @@ int main() {
     renderer.addText([&solver]() {
         return std::format("Bodies: {}", solver.getBodyCount());
     });
+    renderer.addText([&solver]() {
+        return std::format("Constraints: {}", solver.getConstraintSolver() == XPBD ? "XPBD" : "projection");
+    });
     renderer.addText([&run]() {
         if (run)
             return std::pair{"State: Running", sf::Color::Green};
@@ -0,0 +1,68 @@
+#include "../Particles.hpp"
+#include <chrono>
+#include <random>
+
+int main() {
+    const uint32_t count = 50'000;
+    const uint32_t rounds = 20;
+
+    // a loose pile of particles, the broadphase supplies realistic candidate pairs
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> position{0.f, 2000.f};
+    std::uniform_real_distribution<float> radius{2.f, 6.f};
+
+    List<Body*> bodies;
+    BodyStore store;
+    store.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        bodies.push_back(new CircleBody({position(rng), position(rng)}, radius(rng), Materials::ideal));
+        store.adopt(bodies.back());
+    }
+
+    List<BodyPair> pairs;
+    UniformGrid grid;
+    grid.update(store, pairs);
+
+    List<uint32_t> first, second;
+    for (auto [i, j] : pairs) {
+        first.push_back(i);
+        second.push_back(j);
+    }
+
+    auto report = [&](const char* name, uint32_t hits, double ns) {
+        std::cout << std::format("{:<12} {:>8} pairs {:>7} hits {:>7.2f} ns/pair",
+                                 name, pairs.size(), hits, ns / (rounds * pairs.size())) << std::endl;
+    };
+
+    uint32_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; ++round) {
+        hits = 0;
+        for (auto [i, j] : pairs) {
+            Manifold manifold;
+            hits += Collisions::collide(store.bodies[i], store.bodies[j], manifold);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    report("per pair", hits, std::chrono::duration<double, std::nano>(end - start).count());
+
+    List<CircleContact> contacts;
+    for (SimdLevel level : {SIMD_NONE, SIMD_SSE, SIMD_NEON, SIMD_AVX2}) {
+        if (!Simd::supported(level))
+            continue;
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t round = 0; round < rounds; ++round) {
+            contacts.clear();
+            CircleBatch::collide(store, first, second, contacts, level);
+        }
+        end = std::chrono::steady_clock::now();
+        report(Simd::name(level), static_cast<uint32_t>(contacts.size()),
+               std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    for (Body* body : bodies)
+        delete body;
+
+    return 0;
+}
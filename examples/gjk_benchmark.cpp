@@ -0,0 +1,51 @@
+#include "../Particles.hpp"
+#include <chrono>
+
+// SAT against GJK/EPA on pairs of regular polygons with more and more vertices, and on a polygon and a
+// circle. each pair is tested apart, where GJK only runs the distance, and overlapping, where EPA runs as well
+int main() {
+    const uint32_t pair_tests = 200'000;
+    const float radius = 20.f;
+
+    uint32_t hits = 0;
+    auto run = [&](Body* a, Body* b, NarrowphaseType type) {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t n = 0; n < pair_tests; ++n) {
+            Manifold manifold;
+            hits += Collisions::collide(a, b, manifold, type);
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / pair_tests;
+    };
+
+    std::cout << std::format("{:>8} {:>10} {:>12} {:>10} {:>12}", "sides", "case", "SAT ns", "GJK ns", "GJK / SAT") << std::endl;
+    for (uint32_t sides : {3u, 4u, 8u, 16u, 32u, 64u}) {
+        auto circle = new CircleBody({0.f, 0.f}, radius, Materials::wood);
+        auto polygon = new RegularPolygonBody({0.f, 0.f}, radius, sides, Materials::wood);
+        // turned a little, so the faces do not line up
+        auto other = new RegularPolygonBody({0.f, 0.f}, radius, sides, Materials::wood);
+        other->setAngle(other->angle() + 0.3f);
+
+        // apart past the circumscribed circles, overlapping inside the inscribed ones
+        const float apothem = radius * std::cos(Math::PI / static_cast<float>(sides));
+        const std::pair<const char*, float> reaches[] = {{"apart", radius + 1.f}, {"overlap", apothem - 1.f}};
+        for (auto [name, reach] : reaches) {
+            other->setPosition({2.f * reach, 0.f});
+            circle->setPosition({reach + radius, 0.f});
+
+            const double sat = run(polygon, other, SAT), gjk = run(polygon, other, GJK_EPA);
+            std::cout << std::format("{:>8} {:>10} {:>12.1f} {:>10.1f} {:>12.2f}", sides, name, sat, gjk, gjk / sat) << std::endl;
+
+            const double sat_circle = run(polygon, circle, SAT), gjk_circle = run(polygon, circle, GJK_EPA);
+            std::cout << std::format("{:>8} {:>10} {:>12.1f} {:>10.1f} {:>12.2f}", sides, std::format("{} c", name),
+                                     sat_circle, gjk_circle, gjk_circle / sat_circle) << std::endl;
+        }
+
+        delete circle;
+        delete polygon;
+        delete other;
+    }
+
+    std::cout << "hits: " << hits << std::endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "../Particles.hpp"
+#include <chrono>
+#include <random>
+
+// the layout bodies had before BodyStore: one heap object per body, state inline, virtual update
+struct LegacyBody {
+    Vec2 force, position, velocity, acceleration;
+    float angular_acceleration = 0.f, angular_velocity = 0.f, angle = 0.f;
+    float max_speed = std::numeric_limits<float>::infinity();
+    float max_angular_speed = std::numeric_limits<float>::infinity();
+    float inverse_mass = 1.f;
+    bool is_static = false;
+    AABB aabb;
+
+    virtual ~LegacyBody() = default;
+
+    virtual void update(float dt) {
+        acceleration += force * inverse_mass;
+
+        Vec2 new_velocity = velocity + acceleration * dt;
+        if (std::abs(new_velocity) <= max_speed)
+            velocity = new_velocity;
+
+        Vec2 dx = velocity * dt;
+        position += dx;
+        aabb.min += dx;
+        aabb.max += dx;
+
+        float new_angular_velocity = angular_velocity + angular_acceleration * dt;
+        if (std::abs(new_angular_velocity) <= max_angular_speed)
+            angular_velocity = new_angular_velocity;
+        angle += angular_velocity * dt;
+
+        acceleration = {};
+        force = {};
+    }
+};
+
+int main() {
+    const Vec2 gravity{0.f, 1500.f};
+    const float dt = 1.f / 960.f;
+    const uint32_t steps = 200;
+
+    for (uint32_t count : {10'000u, 100'000u}) {
+        std::mt19937 rng{42};
+        std::uniform_real_distribution<float> dist{0.f, 1000.f};
+
+        // interleave the legacy objects with other allocations and shuffle them, like a real heap
+        List<LegacyBody*> legacy;
+        List<Body*> bodies;
+        for (uint32_t i = 0; i < count; ++i) {
+            auto legacy_body = new LegacyBody;
+            legacy_body->position = {dist(rng), dist(rng)};
+            legacy.push_back(legacy_body);
+            bodies.push_back(new CircleBody({dist(rng), dist(rng)}, 4.f, Materials::ideal));
+        }
+        std::shuffle(legacy.begin(), legacy.end(), rng);
+
+        BodyStore store;
+        store.reserve(count);
+        for (Body* body : bodies)
+            store.adopt(body);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t step = 0; step < steps; ++step) {
+            for (LegacyBody* body : legacy) {
+                if (!body->is_static)
+                    body->acceleration += gravity;
+            }
+            for (LegacyBody* body : legacy)
+                body->update(dt);
+        }
+        auto end = std::chrono::steady_clock::now();
+        const double legacy_ns = std::chrono::duration<double, std::nano>(end - start).count() / (steps * count);
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t step = 0; step < steps; ++step) {
+            store.applyGravity(gravity.x, gravity.y);
+            store.integrate(dt);
+        }
+        end = std::chrono::steady_clock::now();
+        const double store_ns = std::chrono::duration<double, std::nano>(end - start).count() / (steps * count);
+
+        std::cout << std::format("{:>7} bodies: pointer list {:.2f} ns/body, body store {:.2f} ns/body ({:.1f}x)",
+                                 count, legacy_ns, store_ns, legacy_ns / store_ns) << std::endl;
+
+        for (LegacyBody* body : legacy)
+            delete body;
+        for (Body* body : bodies)
+            delete body;
+    }
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "../Particles.hpp"
+#include "allocation_counter.hpp"
+#include <chrono>
+
+int main() {
+    const uint32_t pair_tests = 1'000'000;
+
+    List<PolygonBody*> polygons = {
+        new RectangleBody({0.f, 0.f}, 40.f, 20.f, Materials::wood),
+        new RectangleBody({25.f, 5.f}, 40.f, 20.f, Materials::wood),
+        new RegularPolygonBody({10.f, 20.f}, 15.f, 6, Materials::wood),
+        new RegularPolygonBody({-10.f, 15.f}, 12.f, 32, Materials::wood),
+    };
+    auto circle = new CircleBody({5.f, 5.f}, 10.f, Materials::ideal);
+
+    uint32_t hits = 0;
+    auto run = [&](const char* name, auto &&test) {
+        const uint64_t before = allocations;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t n = 0; n < pair_tests; ++n)
+            hits += test(n);
+
+        const auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count() / pair_tests;
+        const double per_test = static_cast<double>(allocations - before) / pair_tests;
+        std::cout << std::format("{:<20} {:>8.1f} ns/test {:>6.2f} allocations/test", name, ns, per_test) << std::endl;
+    };
+
+    run("polygon-polygon", [&](uint32_t n) {
+        PolygonBody* a = polygons[n % polygons.size()];
+        PolygonBody* b = polygons[(n + 1) % polygons.size()];
+        Manifold manifold;
+        return Collisions::intersectPolygons(a->position(), a->vertices(), a->normals(),
+                                             b->position(), b->vertices(), b->normals(), manifold);
+    });
+
+    run("circle-polygon", [&](uint32_t n) {
+        PolygonBody* b = polygons[n % polygons.size()];
+        Manifold manifold;
+        return Collisions::intersectCircleAndPolygon(circle->position(), circle->radius(),
+                                                     b->position(), b->vertices(), b->normals(), manifold);
+    });
+
+    std::cout << "hits: " << hits << std::endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "../Particles.hpp"
+#include "allocation_counter.hpp"
+#include <chrono>
+#include <deque>
+
+// an emitter over a floor: every frame adds a burst of circles and polygons and removes as many of the oldest
+// once the scene is full, so after the first seconds bodies come and go at a steady rate. the same run with
+// bodies made by new and deleted after removal, and with bodies from the solver's pools. the oldest are kept
+// as handles, getBody tells whether one is still there. a pile on a shelf beside the floor sleeps throughout
+int main() {
+    const uint32_t frames = 1200;
+    const uint32_t burst = 40;          // bodies added and, once full, removed per frame
+    const uint32_t max_bodies = 3000;
+
+    auto run = [&](bool pooled) {
+        Solver solver{{0.f, 1500.f}, 4, 120};
+        solver.setBroadphase(UNIFORM_GRID);
+        auto floor = new RectangleBody({1000.f, 1000.f}, 2000.f, 40.f, Materials::stone);
+        floor->setStatic(true);
+        solver.addBody(floor);
+
+        // a pile beside it that falls asleep, every removal then runs with sleeping islands around
+        auto shelf = new RectangleBody({2600.f, 1000.f}, 400.f, 40.f, Materials::stone);
+        shelf->setStatic(true);
+        solver.addBody(shelf);
+        for (uint32_t n = 0; n < 300; ++n)
+            solver.createCircle({2420.f + static_cast<float>(n % 30) * 12.5f, 970.f - static_cast<float>(n / 30) * 12.5f},
+                                6.f, Materials::wood);
+
+        std::deque<BodyHandle> alive;
+        uint32_t spawned = 0, removed = 0;
+        uint64_t churn_allocations = 0;
+        double churn_ns = 0.0;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t f = 0; f < frames; ++f) {
+            const uint64_t before = allocations;
+            const auto churn_start = std::chrono::steady_clock::now();
+
+            while (alive.size() + burst > max_bodies) {
+                Body* body = solver.getBody(alive.front());
+                alive.pop_front();
+                solver.removeBody(body);
+                if (!pooled)
+                    delete body;
+                removed++;
+            }
+
+            for (uint32_t n = 0; n < burst; ++n, ++spawned) {
+                const Vec2 position{50.f + static_cast<float>(spawned * 37 % 1900), 100.f + static_cast<float>(n % 4) * 30.f};
+                Body* body;
+                if (spawned % 4 == 0)
+                    body = pooled ? &solver.createRegularPolygon(position, 8.f, 3 + spawned % 5, Materials::wood)
+                                  : &solver.addBody(new RegularPolygonBody(position, 8.f, 3 + spawned % 5, Materials::wood));
+                else
+                    body = pooled ? &solver.createCircle(position, 6.f, Materials::wood)
+                                  : &solver.addBody(new CircleBody(position, 6.f, Materials::wood));
+                alive.push_back(body->handle());
+            }
+
+            churn_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - churn_start).count();
+            churn_allocations += allocations - before;
+            solver.update();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        // bodies made with new are still owned here
+        if (!pooled) {
+            for (BodyHandle handle : alive) {
+                Body* body = solver.getBody(handle);
+                solver.removeBody(body);
+                delete body;
+            }
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count() / frames;
+        const double churned = spawned + removed;
+        std::cout << std::format("{:<8} {:>8.3f} ms/frame {:>10.1f} ns/body churned {:>8.2f} allocations/body churned",
+                                 pooled ? "pooled" : "new", ms, churn_ns / churned,
+                                 static_cast<double>(churn_allocations) / churned) << std::endl;
+    };
+
+    run(false);
+    run(true);
+    return 0;
+}
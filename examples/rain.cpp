@@ -0,0 +1,63 @@
+#include "../Particles.hpp"
+
+int main() {
+    const Vec2 window_size{1000.f, 800.f};
+    const uint32_t frame_rate = 120;
+    const uint32_t antialiasing_level = 8;
+    const uint32_t max_bodies = 2000;
+
+    sf::RenderWindow window(sf::VideoMode(static_cast<uint32_t>(window_size.x), static_cast<uint32_t>(window_size.y)),
+                            "rain", sf::Style::Default, sf::ContextSettings(0, 0, antialiasing_level));
+    // drops falling at 3000 px/s onto a 4 px floor, at two substeps instead of eight. speculative contacts stop
+    // them at what they are about to hit, drops knocked on faster than the bullet speed are swept
+    Solver solver{{0.f, 1500.f}, 2, frame_rate};
+    solver.setBroadphase(UNIFORM_GRID);
+    solver.setSpeculativeContacts(true);
+    solver.setBulletSpeed(1000.f);
+    Renderer renderer{window};
+    sfev::EventManager evm{window, true};
+
+    window.setFramerateLimit(frame_rate);
+    evm.addEventCallback(sf::Event::Closed, [&window](sf::Event) { window.close(); });
+    evm.addKeyPressedCallback(sf::Keyboard::Escape, [&window](sf::Event) { window.close(); });
+
+    auto &floor = solver.addBody(new RectangleBody({window_size.x / 2, window_size.y - 20.f}, window_size.x, 4.f,
+                                                   Materials::ideal));
+    floor.setColor(sf::Color::White).setStatic(true);
+    for (float x : {0.f, window_size.x}) {
+        auto &wall = solver.addBody(new RectangleBody({x, window_size.y / 2}, 10.f, window_size.y, Materials::ideal));
+        wall.setColor(sf::Color::White).setStatic(true);
+    }
+
+    uint32_t escaped = 0;
+    renderer.addText([&solver, &escaped]() {
+        return std::format("Bodies: {}, fell through: {}", solver.getBodyCount(), escaped);
+    });
+
+    while (window.isOpen()) {
+        if (solver.getBodyCount() < max_bodies) {
+            for (uint32_t k = 0; k < 5; ++k) {
+                const Vec2 position{RNGf::getRange(20.f, window_size.x - 20.f), -50.f};
+                auto &drop = solver.addBody(new CircleBody(position, RNGf::getRange(4.f, 7.f), Materials::wood));
+                drop.setVelocity({0.f, 3000.f}).setColor(getRainbow(solver.getTime()));
+            }
+        }
+
+        for (Body* body : solver.getBodyList()) {
+            if (body->position().y > window_size.y) {
+                solver.removeBody(body);
+                delete body;
+                escaped++;
+                break;
+            }
+        }
+
+        evm.processEvents();
+        solver.update();
+        window.clear(sf::Color::Black);
+        renderer.render(solver);
+        window.display();
+    }
+
+    return 0;
+}
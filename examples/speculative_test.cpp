@@ -0,0 +1,78 @@
+#include "../Particles.hpp"
+
+// the billiards table of cuesports shot hard in 16 directions, and rain falling at 3000 px/s onto a 4 px floor,
+// both at two substeps with speculative contacts and bullets as those examples run them. exits with 1 when
+// any ball or drop ends up outside the walls or under the floor
+int main() {
+    const Vec2 window_size{1000.f, 600.f};
+    const uint32_t frame_rate = 120;
+    const uint32_t sub_steps = 2;
+
+    auto wall = [](Solver &solver, Vec2 center, float width, float height) {
+        auto body = new RectangleBody(center, width, height, Materials::ideal);
+        body->setStatic(true);
+        solver.addBody(body);
+    };
+    auto outside = [&](const Body* body) {
+        const Vec2 position = body->position();
+        return position.x < 0.f || position.x > window_size.x || position.y < -window_size.y
+            || position.y > window_size.y;
+    };
+
+    uint32_t balls_escaped = 0;
+    for (uint32_t shot = 0; shot < 16; ++shot) {
+        Solver solver{{0.f, 0.f}, sub_steps, frame_rate};
+        solver.setSpeculativeContacts(true);
+
+        List<Body*> balls;
+        balls.push_back(&solver.addBody(new CircleBody({window_size.x / 3, window_size.y / 2}, 18.f, Materials::ideal)));
+        for (int i = 0; i < 5; i++) {
+            for (int j = 0; j <= i; j++) {
+                const Vec2 position{window_size.x / 2 + 40.f * i, window_size.y / 2 - 20.f * i + 40.f * j};
+                balls.push_back(&solver.addBody(new CircleBody(position, 18.f, Materials::ideal)));
+            }
+        }
+        for (Body* ball : balls)
+            ball->setBullet(true);
+        wall(solver, {window_size.x / 2, 0}, window_size.x + 10, 10);
+        wall(solver, {window_size.x / 2, window_size.y}, window_size.x + 10, 10);
+        wall(solver, {0, window_size.y / 2}, 10, window_size.y + 10);
+        wall(solver, {window_size.x, window_size.y / 2}, 10, window_size.y + 10);
+
+        // as hard as a drag across the whole window in cuesports
+        const float angle = static_cast<float>(shot) * 0.39f + 0.1f;
+        balls[0]->addForce(-Vec2{std::cos(angle), std::sin(angle)} * 1200.f * 1000000.f);
+
+        for (uint32_t f = 0; f < 240; ++f)
+            solver.update();
+        balls_escaped += static_cast<uint32_t>(std::count_if(balls.begin(), balls.end(), outside));
+    }
+
+    Solver solver{{0.f, 1500.f}, sub_steps, frame_rate};
+    solver.setBroadphase(UNIFORM_GRID);
+    solver.setSpeculativeContacts(true);
+    solver.setBulletSpeed(1000.f);
+    wall(solver, {window_size.x / 2, window_size.y}, window_size.x + 10, 4);
+    wall(solver, {0, 0}, 10, 2 * window_size.y + 10);
+    wall(solver, {window_size.x, 0}, 10, 2 * window_size.y + 10);
+
+    List<Body*> drops;
+    for (uint32_t f = 0; f < 600; ++f) {
+        if (f < 400 && f % 2 == 0) {
+            for (uint32_t k = 0; k < 10; ++k) {
+                const Vec2 position{50.f + 90.f * static_cast<float>(k) + static_cast<float>(f % 7) * 3.f, -2000.f};
+                auto drop = new CircleBody(position, 5.f + static_cast<float>(k % 3), Materials::wood);
+                drop->setVelocity({0.f, 3000.f});
+                drops.push_back(&solver.addBody(drop));
+            }
+        }
+        solver.update();
+    }
+    const auto drops_escaped = static_cast<uint32_t>(std::count_if(drops.begin(), drops.end(), outside));
+
+    std::cout << std::format("billiards: {} balls escaped, rain: {} of {} drops fell through", balls_escaped,
+                             drops_escaped, drops.size()) << std::endl;
+    const bool failed = balls_escaped > 0 || drops_escaped > 0;
+    std::cout << (failed ? "FAILED" : "passed") << std::endl;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+#include "../Particles.hpp"
+#include <chrono>
+
+// a column of boxes on a static floor, left to settle. a stable stack ends with its top box where it
+// started, give or take the slop, and with next to no motion left
+int main() {
+    const uint32_t boxes = 12;
+    const float size = 40.f;
+    const float floor_top = 600.f;
+    const uint32_t frames = 600;
+    const uint32_t measured = 120;      // residual motion over the last frames
+
+    auto run = [&](uint32_t sub_steps, bool warm_starting) {
+        List<Body*> bodies;     // the solver hands its bodies back when destroyed, delete them after it
+        Solver solver{{0.f, 980.f}, sub_steps, 60};
+        solver.setSleeping(false);
+        solver.setWarmStarting(warm_starting);
+
+        auto floor = new RectangleBody({400.f, floor_top + 10.f}, 800.f, 20.f, Materials::stone);
+        floor->setStatic(true);
+        solver.addBody(floor);
+        bodies.push_back(floor);
+
+        List<Body*> stack;
+        for (uint32_t i = 0; i < boxes; ++i) {
+            stack.push_back(new RectangleBody({400.f, floor_top - size * (0.5f + i)}, size, size, Materials::wood));
+            solver.addBody(stack.back());
+            bodies.push_back(stack.back());
+        }
+        const float top_start = stack.back()->position().y;
+
+        float motion = 0.f;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t f = 0; f < frames; ++f) {
+            solver.update();
+            if (f < frames - measured)
+                continue;
+            for (Body* body : stack)
+                motion += body->speed();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << std::format("{} substeps, warm start {:<3} top sank {:>6.2f} px  mean speed {:>8.3f} px/s  {:>6.3f} ms/frame",
+                                 sub_steps, warm_starting ? "on" : "off", stack.back()->position().y - top_start,
+                                 motion / (measured * boxes),
+                                 std::chrono::duration<double, std::milli>(end - start).count() / frames) << std::endl;
+
+        return bodies;
+    };
+
+    for (uint32_t sub_steps : {1u, 2u, 8u}) {
+        for (bool warm_starting : {false, true}) {
+            for (Body* body : run(sub_steps, warm_starting))
+                delete body;
+        }
+    }
+
+    return 0;
+}
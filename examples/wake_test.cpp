@@ -0,0 +1,90 @@
+#include "../Particles.hpp"
+
+// sleeping stacks disturbed through the static floor they rest on: the floor teleported down, pushed up into
+// the stack, slid under a stack it never touched, and moving down or up on its own velocity like a platform.
+// every broadphase. the stacks must wake and end up resting on the floor, neither floating above it nor sunk
+// into it. exits with 1 when one does not
+int main() {
+    const uint32_t settle_frames = 300;
+    const uint32_t test_frames = 120;
+    const float size = 20.f;
+
+    const char* names[] = {"all pairs", "uniform grid", "sweep and prune", "aabb tree"};
+    const char* disturbances[] = {"teleported down", "pushed up", "slid under", "sinking platform", "rising platform"};
+
+    bool failed = false;
+    for (BroadphaseType broadphase : {ALL_PAIRS, UNIFORM_GRID, SWEEP_AND_PRUNE, AABB_TREE}) {
+        for (uint32_t disturbance = 0; disturbance < 5; ++disturbance) {
+            Solver solver{{0.f, 1000.f}, 4, 60};
+            solver.setBroadphase(broadphase);
+            solver.setBroadphaseThreshold(0);
+
+            // the floor under stack a, and a pedestal under stack b that the floor never touches until slid under
+            auto floor = new RectangleBody({300.f, 500.f}, 400.f, 20.f, Materials::stone);
+            auto pedestal = new RectangleBody({800.f, 500.f}, 40.f, 20.f, Materials::stone);
+            floor->setStatic(true);
+            pedestal->setStatic(true);
+            solver.addBody(floor);
+            solver.addBody(pedestal);
+
+            List<Body*> stack_a, stack_b;
+            for (uint32_t k = 0; k < 5; ++k) {
+                const float y = 490.f - size / 2.f - (size + 0.5f) * static_cast<float>(k);
+                stack_a.push_back(&solver.addBody(new RectangleBody({300.f, y}, size, size, Materials::wood)));
+                stack_b.push_back(&solver.addBody(new RectangleBody({800.f, y}, size, size, Materials::wood)));
+            }
+
+            for (uint32_t f = 0; f < settle_frames; ++f)
+                solver.update();
+            const bool slept = solver.getAwakeBodyCount() == 0;
+
+            List<Body*>* stack = &stack_a;
+            switch (disturbance) {
+                case 0:
+                    floor->setPosition({300.f, 600.f});
+                    break;
+                case 1:
+                    floor->setPosition({300.f, 492.f});
+                    break;
+                case 2:
+                    floor->setPosition({800.f, 495.f});
+                    stack = &stack_b;
+                    break;
+                case 3:
+                    floor->setVelocity({0.f, 50.f});
+                    break;
+                default:
+                    floor->setVelocity({0.f, -50.f});
+                    break;
+            }
+
+            for (uint32_t f = 0; f < test_frames; ++f)
+                solver.update();
+
+            // how far the bottom box hangs above the floor, negative when sunk into it
+            const float floor_top = floor->position().y - 10.f;
+            const float gap = floor_top - ((*stack)[0]->position().y + size / 2.f);
+            const bool ok = slept && std::abs(gap) < 2.f;
+
+            std::cout << std::format("{:<16} {:<17} gap {:>8.3f}{}", names[broadphase], disturbances[disturbance],
+                                     gap, slept ? "" : ", never slept") << std::endl;
+            failed |= !ok;
+
+            solver.removeBody(floor);
+            solver.removeBody(pedestal);
+            delete floor;
+            delete pedestal;
+            for (Body* body : stack_a) {
+                solver.removeBody(body);
+                delete body;
+            }
+            for (Body* body : stack_b) {
+                solver.removeBody(body);
+                delete body;
+            }
+        }
+    }
+
+    std::cout << (failed ? "FAILED" : "passed") << std::endl;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include "../engine/Collisions.hpp"
+
+// sequential impulses on the contact velocities, one point at a time or both points of a face together. the
+// accumulated impulse of every point is clamped rather than each iteration's, which lets it carry over into the
+// next substep as a warm start.
+// restitution runs as a pass of its own afterwards and is left out of the accumulated impulse, a bounce
+// warm started into a resting stack would keep it bouncing.
+// a manifold of negative depth is a speculative contact between bodies still apart, see
+// Solver::setSpeculativeContacts. it bounces as soon as it pushes, up to a substep before the bodies touch,
+// and limitApproach keeps the bounces of other contacts from carrying a body across its gap.
+// static bodies are only read, other threads may be reading them too.
+class ContactSolver {
+ public:
+    static constexpr float BAUMGARTE = 0.2f;                // share of the penetration pushed out per substep
+    static constexpr float SLOP = 0.5f;                     // penetration left alone, in px, so resting contacts stay touching
+    static constexpr float RESTITUTION_THRESHOLD = 100.f;   // slower approaches do not bounce, in px/s
+    static constexpr float MAX_CONDITION = 1000.f;          // two points whose rows are closer to parallel are solved one by one
+
+ private:
+    // impulse acts on b at the point, and the opposite on a
+    static void applyImpulse(const Manifold &manifold, const ContactPoint &point, Vec2 impulse) {
+        Body* a = manifold.bodyA;
+        Body* b = manifold.bodyB;
+        if (a->inverseMass() > 0.f) {
+            a->setVelocity(a->velocity() - impulse * a->inverseMass());
+            a->setAngularVelocity(a->angularVelocity() - a->inverseInertia() * Math::cross(point.offset_a, impulse));
+        }
+        if (b->inverseMass() > 0.f) {
+            b->setVelocity(b->velocity() + impulse * b->inverseMass());
+            b->setAngularVelocity(b->angularVelocity() + b->inverseInertia() * Math::cross(point.offset_b, impulse));
+        }
+    }
+
+    // velocity of b relative to a at the point, rotation included
+    static Vec2 relativeVelocity(const Manifold &manifold, const ContactPoint &point) {
+        const Body* a = manifold.bodyA;
+        const Body* b = manifold.bodyB;
+        const float w_a = a->angularVelocity(), w_b = b->angularVelocity();
+        return b->velocity() + Vec2{-w_b * point.offset_b.y, w_b * point.offset_b.x}
+            - a->velocity() - Vec2{-w_a * point.offset_a.y, w_a * point.offset_a.x};
+    }
+
+    static float effectiveMass(const Manifold &manifold, const ContactPoint &point, Vec2 direction) {
+        const Body* a = manifold.bodyA;
+        const Body* b = manifold.bodyB;
+        const float ra = Math::cross(point.offset_a, direction), rb = Math::cross(point.offset_b, direction);
+        const float k = a->inverseMass() + b->inverseMass() + a->inverseInertia() * ra * ra + b->inverseInertia() * rb * rb;
+        return k > 0.f ? 1.f / k : 0.f;
+    }
+
+    static Vec2 tangentOf(Vec2 normal) {
+        return {-normal.y, normal.x};
+    }
+
+    // a point the iterations left without load came apart on its own
+    static bool bounces(const ContactPoint &point) {
+        return point.bounce > 0.f && point.normal_impulse > 0.f;
+    }
+
+ public:
+    // lever arms, effective masses, friction and the velocities the normal impulses aim for. the impulses are
+    // kept, they are either warm started values or zero
+    static void prepare(Manifold &manifold, float dt) {
+        Body* a = manifold.bodyA;
+        Body* b = manifold.bodyB;
+        const Vec2 tangent = tangentOf(manifold.normal);
+        const float restitution = a->material().restitution * b->material().restitution;
+        manifold.friction = std::sqrt(a->material().uk * b->material().uk);
+
+        for (uint32_t n = 0; n < manifold.contact_count; ++n) {
+            ContactPoint &point = manifold.points[n];
+            point.offset_a = manifold.contact(n) - a->position();
+            point.offset_b = manifold.contact(n) - b->position();
+            point.normal_mass = effectiveMass(manifold, point, manifold.normal);
+            point.tangent_mass = effectiveMass(manifold, point, tangent);
+
+            const float vn = relativeVelocity(manifold, point) * manifold.normal;
+            point.bounce = vn < -RESTITUTION_THRESHOLD ? -restitution * vn : 0.f;
+            // the same for every point, pushing the deeper point harder lets the correction tip a stack over.
+            // a speculative contact lets the bodies approach by as much as closes the gap within the substep
+            point.velocity_bias = manifold.depth < 0.f ? point.depth / dt
+                                                       : BAUMGARTE / dt * std::max(manifold.depth - SLOP, 0.f);
+        }
+
+        // the two normal rows of a face contact are coupled through the rotation, solving them one at a time
+        // has them push each other back and forth for many iterations
+        std::fill_n(manifold.normal_matrix, 3, 0.f);
+        if (manifold.contact_count == 2) {
+            const ContactPoint &p1 = manifold.points[0], &p2 = manifold.points[1];
+            const float ra1 = Math::cross(p1.offset_a, manifold.normal), rb1 = Math::cross(p1.offset_b, manifold.normal);
+            const float ra2 = Math::cross(p2.offset_a, manifold.normal), rb2 = Math::cross(p2.offset_b, manifold.normal);
+            const float m = a->inverseMass() + b->inverseMass();
+            const float i_a = a->inverseInertia(), i_b = b->inverseInertia();
+
+            const float k11 = m + i_a * ra1 * ra1 + i_b * rb1 * rb1;
+            const float k22 = m + i_a * ra2 * ra2 + i_b * rb2 * rb2;
+            const float k12 = m + i_a * ra1 * ra2 + i_b * rb1 * rb2;
+            if (k11 * k11 < MAX_CONDITION * (k11 * k22 - k12 * k12)) {
+                manifold.normal_matrix[0] = k11;
+                manifold.normal_matrix[1] = k12;
+                manifold.normal_matrix[2] = k22;
+            }
+        }
+    }
+
+    // applies the impulses carried over from the last substep
+    static void warmStart(const Manifold &manifold) {
+        const Vec2 tangent = tangentOf(manifold.normal);
+        for (uint32_t n = 0; n < manifold.contact_count; ++n) {
+            const ContactPoint &point = manifold.points[n];
+            applyImpulse(manifold, point, manifold.normal * point.normal_impulse + tangent * point.tangent_impulse);
+        }
+    }
+
+    // one iteration. friction first, bounded by the normal impulse of the previous iteration
+    static void solveVelocity(Manifold &manifold) {
+        const Vec2 tangent = tangentOf(manifold.normal);
+
+        for (uint32_t n = 0; n < manifold.contact_count; ++n) {
+            ContactPoint &point = manifold.points[n];
+            const float vt = relativeVelocity(manifold, point) * tangent;
+            const float max_friction = manifold.friction * point.normal_impulse;
+            const float old_tangent = point.tangent_impulse;
+            point.tangent_impulse = std::clamp(old_tangent - vt * point.tangent_mass, -max_friction, max_friction);
+            applyImpulse(manifold, point, tangent * (point.tangent_impulse - old_tangent));
+        }
+
+        if (manifold.normal_matrix[0] > 0.f) {
+            solveBlock(manifold);
+            return;
+        }
+
+        for (uint32_t n = 0; n < manifold.contact_count; ++n) {
+            ContactPoint &point = manifold.points[n];
+            const float vn = relativeVelocity(manifold, point) * manifold.normal;
+            const float old_normal = point.normal_impulse;
+            point.normal_impulse = std::max(old_normal - (vn - point.velocity_bias) * point.normal_mass, 0.f);
+            applyImpulse(manifold, point, manifold.normal * (point.normal_impulse - old_normal));
+        }
+    }
+
+    // both normal impulses at once: the accumulated x >= 0 with K x + b >= 0 and x (K x + b) = 0, b the
+    // velocities aimed for less what the old impulses already did. two unknowns, so the four ways the
+    // points can be pushing or not are tried in turn. none fitting only happens through round off, the
+    // impulses are left as they are then
+    static void solveBlock(Manifold &manifold) {
+        ContactPoint &p1 = manifold.points[0], &p2 = manifold.points[1];
+        const float k11 = manifold.normal_matrix[0], k12 = manifold.normal_matrix[1], k22 = manifold.normal_matrix[2];
+        const float old1 = p1.normal_impulse, old2 = p2.normal_impulse;
+
+        const float vn1 = relativeVelocity(manifold, p1) * manifold.normal;
+        const float vn2 = relativeVelocity(manifold, p2) * manifold.normal;
+        const float b1 = vn1 - p1.velocity_bias - (k11 * old1 + k12 * old2);
+        const float b2 = vn2 - p2.velocity_bias - (k12 * old1 + k22 * old2);
+
+        float x1, x2;
+        const float det = k11 * k22 - k12 * k12;
+        if (x1 = (k12 * b2 - k22 * b1) / det, x2 = (k12 * b1 - k11 * b2) / det; x1 >= 0.f && x2 >= 0.f) {
+            // both push
+        }
+        else if (x1 = -b1 / k11, x2 = 0.f; x1 >= 0.f && k12 * x1 + b2 >= 0.f) {
+            // only the first pushes, the second separates
+        }
+        else if (x1 = 0.f, x2 = -b2 / k22; x2 >= 0.f && k12 * x2 + b1 >= 0.f) {
+            // only the second pushes
+        }
+        else if (x1 = 0.f, x2 = 0.f; b1 >= 0.f && b2 >= 0.f) {
+            // both separate
+        }
+        else {
+            return;
+        }
+
+        p1.normal_impulse = x1;
+        p2.normal_impulse = x2;
+        applyImpulse(manifold, p1, manifold.normal * (x1 - old1));
+        applyImpulse(manifold, p2, manifold.normal * (x2 - old2));
+    }
+
+    // once the iterations are done, points that hit fast enough separate at the bounce speed
+    static void applyRestitution(const Manifold &manifold) {
+        const ContactPoint &p1 = manifold.points[0], &p2 = manifold.points[1];
+        // a face that hit flat bounces as one, each point on its own would add to the other's rebound
+        if (manifold.normal_matrix[0] > 0.f && bounces(p1) && bounces(p2)) {
+            const float k11 = manifold.normal_matrix[0], k12 = manifold.normal_matrix[1], k22 = manifold.normal_matrix[2];
+            const float b1 = relativeVelocity(manifold, p1) * manifold.normal - p1.bounce;
+            const float b2 = relativeVelocity(manifold, p2) * manifold.normal - p2.bounce;
+            const float det = k11 * k22 - k12 * k12;
+            // the total impulses still only push
+            const float x1 = std::max((k12 * b2 - k22 * b1) / det, -p1.normal_impulse);
+            const float x2 = std::max((k12 * b1 - k11 * b2) / det, -p2.normal_impulse);
+            applyImpulse(manifold, p1, manifold.normal * x1);
+            applyImpulse(manifold, p2, manifold.normal * x2);
+            return;
+        }
+
+        for (uint32_t n = 0; n < manifold.contact_count; ++n) {
+            const ContactPoint &point = manifold.points[n];
+            if (!bounces(point))
+                continue;
+
+            const float vn = relativeVelocity(manifold, point) * manifold.normal;
+            const float impulse = std::max(-(vn - point.bounce) * point.normal_mass, -point.normal_impulse);
+            applyImpulse(manifold, point, manifold.normal * impulse);
+        }
+    }
+
+    // after restitution, pushes speculative points apart, outside the accumulated impulse like a bounce, as far
+    // as the approach would close more than the gap
+    static void limitApproach(const Manifold &manifold) {
+        if (manifold.depth >= 0.f)
+            return;
+
+        for (uint32_t n = 0; n < manifold.contact_count; ++n) {
+            const ContactPoint &point = manifold.points[n];
+            const float vn = relativeVelocity(manifold, point) * manifold.normal;
+            if (vn < point.velocity_bias)
+                applyImpulse(manifold, point, manifold.normal * ((point.velocity_bias - vn) * point.normal_mass));
+        }
+    }
+};
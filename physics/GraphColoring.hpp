@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <bit>
+#include <cstdint>
+#include <utility>
+
+// splits items that each write up to two bodies into batches in which no body appears twice,
+// so the items of one batch can run concurrently. greedy in item order: item k takes the lowest
+// color none of its bodies has yet, and each batch keeps its items in their original order.
+class GraphColoring {
+ public:
+    static constexpr uint32_t FREE = 0xffffffff;       // a body nobody writes (static), never conflicts
+    static constexpr uint32_t SERIAL = 0xfffffffe;     // unknown bodies, the item goes to the serial batch
+    static constexpr uint32_t MAX_COLORS = 64;
+
+ private:
+    std::vector<uint64_t> used;             // per body row, bit c is set once color c touches it
+    std::vector<uint32_t> color_of;         // per item
+    std::vector<uint32_t> batch_start;      // MAX_COLORS batches and the serial one, then the end
+    std::vector<uint32_t> order;            // item indices grouped by batch
+    std::vector<uint32_t> cursor;
+
+ public:
+    // rows(k) gives the body rows item k writes, FREE or SERIAL where that does not apply
+    template <typename Rows>
+    void build(uint32_t count, uint32_t row_count, const Rows &rows) {
+        used.assign(row_count, 0);
+        color_of.resize(count);
+        batch_start.assign(MAX_COLORS + 2, 0);
+
+        for (uint32_t k = 0; k < count; ++k) {
+            auto [a, b] = rows(k);
+
+            uint32_t color = MAX_COLORS;
+            if (a != SERIAL && b != SERIAL) {
+                const uint64_t busy = (a != FREE ? used[a] : 0) | (b != FREE ? used[b] : 0);
+                color = std::countr_one(busy);      // MAX_COLORS when all are taken
+            }
+
+            if (color < MAX_COLORS) {
+                if (a != FREE)
+                    used[a] |= uint64_t{1} << color;
+                if (b != FREE)
+                    used[b] |= uint64_t{1} << color;
+            }
+
+            color_of[k] = color;
+            batch_start[color + 1]++;
+        }
+
+        // counting sort, stable
+        for (uint32_t c = 1; c < batch_start.size(); ++c)
+            batch_start[c] += batch_start[c - 1];
+
+        order.resize(count);
+        cursor.assign(batch_start.begin(), batch_start.end() - 1);
+        for (uint32_t k = 0; k < count; ++k)
+            order[cursor[color_of[k]]++] = k;
+    }
+
+    // batches 0 to MAX_COLORS - 1 are conflict free, batch MAX_COLORS must run serially
+    [[nodiscard]] static constexpr uint32_t batchCount() {
+        return MAX_COLORS + 1;
+    }
+
+    [[nodiscard]] static constexpr bool isSerial(uint32_t batch) {
+        return batch == MAX_COLORS;
+    }
+
+    [[nodiscard]] std::span<const uint32_t> batch(uint32_t index) const {
+        return std::span{order}.subspan(batch_start[index], batch_start[index + 1] - batch_start[index]);
+    }
+};
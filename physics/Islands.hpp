@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+// groups body rows that are connected through contacts or constraints, with a union-find
+class Islands {
+ public:
+    static constexpr uint32_t NONE = 0xffffffff;
+
+ private:
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> island_of;    // row -> island, NONE for rows left out
+    std::vector<uint32_t> starts;       // island i holds rows[starts[i], starts[i + 1])
+    std::vector<uint32_t> rows;
+    std::vector<uint32_t> root_island;  // root row -> island
+    std::vector<uint32_t> cursor;
+    std::vector<uint32_t> item_island;
+
+    uint32_t find(uint32_t row) {
+        while (parent[row] != row) {
+            parent[row] = parent[parent[row]];
+            row = parent[row];
+        }
+        return row;
+    }
+
+ public:
+    // every row starts in an island of its own
+    void reset(uint32_t row_count) {
+        parent.resize(row_count);
+        for (uint32_t i = 0; i < row_count; ++i)
+            parent[i] = i;
+    }
+
+    // NONE on either side links nothing, static bodies must not join two islands
+    void link(uint32_t a, uint32_t b) {
+        if (a == NONE || b == NONE)
+            return;
+
+        a = find(a);
+        b = find(b);
+        // the smaller row becomes the root, so the result does not depend on the link order
+        if (a < b)
+            parent[b] = a;
+        else if (b < a)
+            parent[a] = b;
+    }
+
+    // collects the islands of the rows for which include(row) holds, ordered by their first included row,
+    // each with its rows in increasing order
+    template <typename F>
+    void build(const F &include) {
+        const auto row_count = static_cast<uint32_t>(parent.size());
+        island_of.assign(row_count, NONE);
+        root_island.assign(row_count, NONE);
+        starts.clear();
+
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < row_count; ++i) {
+            if (!include(i))
+                continue;
+
+            const uint32_t root = find(i);
+            if (root_island[root] == NONE) {
+                root_island[root] = count++;
+                starts.push_back(0);
+            }
+            island_of[i] = root_island[root];
+            starts[island_of[i]]++;
+        }
+
+        // sizes to starts
+        uint32_t total = 0;
+        for (uint32_t &start : starts) {
+            const uint32_t size = start;
+            start = total;
+            total += size;
+        }
+        starts.push_back(total);
+
+        rows.resize(total);
+        cursor.assign(starts.begin(), starts.end() - 1);
+        for (uint32_t i = 0; i < row_count; ++i) {
+            if (island_of[i] != NONE)
+                rows[cursor[island_of[i]]++] = i;
+        }
+    }
+
+    // sorts items (contacts, constraints) by the island of row_of(item), keeping their order inside an island.
+    // island i gets items[starts[i], starts[i + 1]), items whose row is NONE or left out get none
+    template <typename F>
+    void group(uint32_t item_count, const F &row_of, std::vector<uint32_t> &item_starts,
+               std::vector<uint32_t> &items) {
+        item_starts.assign(count() + 1, 0);
+        item_island.resize(item_count);
+        for (uint32_t k = 0; k < item_count; ++k) {
+            const uint32_t row = row_of(k);
+            item_island[k] = row != NONE ? island_of[row] : NONE;
+            if (item_island[k] != NONE)
+                item_starts[item_island[k] + 1]++;
+        }
+        for (uint32_t i = 1; i < item_starts.size(); ++i)
+            item_starts[i] += item_starts[i - 1];
+
+        items.resize(item_starts.back());
+        cursor.assign(item_starts.begin(), item_starts.end() - 1);
+        for (uint32_t k = 0; k < item_count; ++k) {
+            if (item_island[k] != NONE)
+                items[cursor[item_island[k]]++] = k;
+        }
+    }
+
+    [[nodiscard]] uint32_t count() const {
+        return starts.empty() ? 0 : static_cast<uint32_t>(starts.size() - 1);
+    }
+
+    [[nodiscard]] std::span<const uint32_t> island(uint32_t index) const {
+        return std::span{rows}.subspan(starts[index], starts[index + 1] - starts[index]);
+    }
+
+    [[nodiscard]] uint32_t islandOf(uint32_t row) const {
+        return island_of[row];
+    }
+};
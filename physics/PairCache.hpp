@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+#include "../engine/Collisions.hpp"
+
+// what the narrowphase learned about a pair of bodies last substep, keyed by their handles in either order:
+// the contact points of a touching pair, their features and the impulses they ended with for warm starting, or the axis
+// that separated a pair that was apart. two open-addressing tables: lookups read the previous substep's while the
+// current one is being filled. clearing keeps the capacity, so once the pair count settles nothing is allocated.
+class PairCache {
+ public:
+    static constexpr uint32_t EMPTY = 0xffffffff;
+
+    struct Entry {
+        BodyHandle low, high;                   // the two bodies, low.id < high.id. a body that took the id of a
+                                                // removed one has another generation and finds nothing
+        uint32_t first = EMPTY;                 // id of the manifold's bodyA, feature ids depend on the order
+        Vec2 axis;                              // while apart, the last axis the two projected apart on.
+                                                // while touching, the contact normal
+        uint32_t point_count = 0;               // while touching, the points with what they ended the substep with
+        uint32_t feature[2] = {};
+        float normal_impulse[2] = {};
+        float tangent_impulse[2] = {};
+        bool touching = false;
+
+        static Entry separated(BodyHandle a, BodyHandle b, Vec2 axis) {
+            Entry entry;
+            entry.low = a.id < b.id ? a : b;
+            entry.high = a.id < b.id ? b : a;
+            entry.axis = axis;
+            return entry;
+        }
+
+        static Entry contact(const Manifold &manifold) {
+            Entry entry;
+            const BodyHandle a = manifold.bodyA->handle(), b = manifold.bodyB->handle();
+            entry.low = a.id < b.id ? a : b;
+            entry.high = a.id < b.id ? b : a;
+            entry.first = a.id;
+            entry.axis = manifold.normal;
+            entry.point_count = manifold.contact_count;
+            for (uint32_t n = 0; n < manifold.contact_count; ++n) {
+                entry.feature[n] = manifold.points[n].feature;
+                entry.normal_impulse[n] = manifold.points[n].normal_impulse;
+                entry.tangent_impulse[n] = manifold.points[n].tangent_impulse;
+            }
+            entry.touching = true;
+            return entry;
+        }
+    };
+
+ private:
+    std::vector<Entry> previous, current;
+    // every id's pairs as a list through the slots, for both of a pair's ids: link 2 * slot + side, side 0 for low
+    std::vector<uint32_t> previous_head, current_head;      // by id, the first link
+    std::vector<uint32_t> previous_next, current_next;      // by link, the next one
+
+    static uint32_t hash(uint32_t low, uint32_t high) {
+        uint32_t h = low * 0x9e3779b1u;
+        h = (h ^ (h >> 15) ^ high) * 0x85ebca77u;
+        h = (h ^ (h >> 13)) * 0xc2b2ae3du;
+        return h ^ (h >> 16);
+    }
+
+ public:
+    // nullptr when the pair was not seen last substep
+    [[nodiscard]] const Entry* find(BodyHandle a, BodyHandle b) const {
+        if (previous.empty())
+            return nullptr;
+
+        const BodyHandle low = a.id < b.id ? a : b, high = a.id < b.id ? b : a;
+        const auto mask = static_cast<uint32_t>(previous.size() - 1);
+        for (uint32_t slot = hash(low.id, high.id) & mask;; slot = (slot + 1) & mask) {
+            const Entry &entry = previous[slot];
+            if (entry.low.id == EMPTY)
+                return nullptr;
+            if (entry.low == low && entry.high == high)
+                return &entry;
+        }
+    }
+
+    // calls fn with the other body of every pair a was seen in last substep
+    template <typename F>
+    void forEachPartner(BodyHandle a, F &&fn) const {
+        if (a.id >= previous_head.size())
+            return;
+
+        for (uint32_t link = previous_head[a.id]; link != EMPTY; link = previous_next[link]) {
+            const Entry &entry = previous[link / 2];
+            if (link % 2 == 0 && entry.low == a)
+                fn(entry.high);
+            else if (link % 2 == 1 && entry.high == a)
+                fn(entry.low);
+        }
+    }
+
+    // starts filling the next table with room for count pairs
+    void begin(uint32_t count) {
+        // at most half full, so probes stay short and always end at an empty slot
+        const uint32_t capacity = std::bit_ceil(std::max(16u, 2 * count));
+        current.assign(capacity, Entry{});
+        current_next.resize(2 * capacity);
+        std::fill(current_head.begin(), current_head.end(), EMPTY);
+    }
+
+    // a pair inserted twice keeps the later entry
+    void insert(const Entry &entry) {
+        const auto mask = static_cast<uint32_t>(current.size() - 1);
+        uint32_t slot = hash(entry.low.id, entry.high.id) & mask;
+        while (current[slot].low.id != EMPTY && (current[slot].low != entry.low || current[slot].high != entry.high))
+            slot = (slot + 1) & mask;
+
+        if (current[slot].low.id == EMPTY) {
+            if (current_head.size() <= entry.high.id)
+                current_head.resize(entry.high.id + 1, EMPTY);
+            current_next[2 * slot] = current_head[entry.low.id];
+            current_head[entry.low.id] = 2 * slot;
+            current_next[2 * slot + 1] = current_head[entry.high.id];
+            current_head[entry.high.id] = 2 * slot + 1;
+        }
+        current[slot] = entry;
+    }
+
+    // the table just filled becomes the one find reads
+    void end() {
+        std::swap(previous, current);
+        std::swap(previous_head, current_head);
+        std::swap(previous_next, current_next);
+    }
+
+    void clear() {
+        previous.clear();
+        current.clear();
+        previous_head.clear();
+        current_head.clear();
+        previous_next.clear();
+        current_next.clear();
+    }
+};
@@ -2,158 +2,942 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
-#include <cmath>
+#include <memory>
+#include <algorithm>
 #include <SFML/Graphics.hpp>
 
 #include "../utils/math.hpp"
 #include "../engine/common/Constraints.hpp"
 #include "../engine/common/Body.hpp"
+#include "../engine/common/BodyPool.hpp"
 #include "../engine/Collisions.hpp"
+#include "../engine/CircleBatch.hpp"
+#include "../utils/job_system.hpp"
+#include "GraphColoring.hpp"
+#include "PairCache.hpp"
+#include "ContactSolver.hpp"
+#include "Islands.hpp"
+#include "broadphase/Broadphase.hpp"
+#include "broadphase/UniformGrid.hpp"
+#include "broadphase/SweepAndPrune.hpp"
+#include "broadphase/TreeBroadphase.hpp"
 
 class Solver {
  private:
+    // what one narrowphase job works with, kept between substeps so the buffers are reused
+    struct NarrowphaseChunk {
+        List<uint32_t> circle_first, circle_second, circle_pair;   // circle-circle pairs, for the batch
+        List<CircleContact> circle_contacts;
+        List<Manifold> other;                                       // every other shape pair
+        List<uint32_t> other_pair;
+        List<Manifold> manifolds;                                   // both merged, in pair order
+        List<PairCache::Entry> kept;                                // pairs found apart or left untested
+    };
+
     Vec2 gravity;
-    List<Body*> body_list;
+    BodyStore store;
     List<Constraint*> constraint_list;
     List<Manifold> manifolds;
+    List<PairCache::Entry> kept_pairs;     // what the pair cache keeps besides the manifolds
+    List<BodyPair> pairs;
+    List<NarrowphaseChunk> chunks;
+    GraphColoring contact_coloring;
+    GraphColoring constraint_coloring;
+    Islands islands;
+    PairCache pair_cache;
+    List<uint32_t> contact_start, island_contacts;          // manifolds grouped by island
+    List<uint32_t> constraint_start, island_constraints;    // constraints grouped by island
+    List<uint32_t> serial_constraints;                      // constraints that cannot tell their bodies
+    List<uint32_t> island_order;                            // islands with work, largest first
+    List<uint32_t> bin_of, bin_load, bin_start, bin_islands;
+    List<List<BodyHandle>> sleeping_islands;    // indexed by BodyStore::island
+    List<uint32_t> free_sleeping_islands;
+    List<float> swept_min_x, swept_min_y, swept_max_x, swept_max_y;    // the bounds over the substep
+    List<uint32_t> xpbd_constraints;            // the ones with an awake body, or unknown bodies
+    List<float> uncorrected_x, uncorrected_y;   // positions before the xpbd iterations
+    BodyPool<CircleBody> circle_pool;
+    BodyPool<PolygonBody> polygon_pool;
+    BodyPool<RectangleBody> rectangle_pool;
+    BodyPool<RegularPolygonBody> regular_polygon_pool;
+    List<uint8_t> pool_of;                      // by handle id, which pool made the body
+    List<uint32_t> bullet_rows;                 // swept this substep
+    List<float> impact_times;                   // of each, infinity when it hits nothing
+    List<uint32_t> candidate_start, candidates; // what each bullet's path may cross
+    List<std::pair<float, uint32_t>> sorted_x;  // without the broadphase, dynamic rows by their box's min x
+    List<uint32_t> static_rows;                 // and the static ones, checked one by one
+    float widest_x = 0.f;                       // widest dynamic box along x
+    bool sleeping = true;
+    float sleep_linear_speed = 8.f;             // below these a body counts as resting
+    float sleep_angular_speed = 0.1f;
+    float time_to_sleep = 0.5f;                 // an island sleeps once all its bodies rested this long
+    SimdLevel simd_level = Simd::best();
+    float bullet_speed = std::numeric_limits<float>::infinity();    // faster bodies are swept like bullets
+    bool speculative = false;
+    float speculative_margin = 0.f;     // no pair further apart gets a speculative contact this substep
+    NarrowphaseType narrowphase_types[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT] = {};    // all SAT
+    std::unique_ptr<Broadphase> broadphase;
+    BroadphaseType broadphase_type = ALL_PAIRS;
+    bool broadphase_current = false;      // the broadphase was updated this substep, its queries can be used
+    uint32_t broadphase_threshold = 64;   // below this many bodies the all-pairs loop is faster
     uint32_t sub_steps = 1;
+    uint32_t velocity_iterations = 8;
+    uint32_t constraint_iterations = 4;
+    ConstraintSolverType constraint_solver = POSITION_PROJECTION;
+    bool warm_starting = true;
     float time = 0.f;
     float frame_dt = 0.f;
 
+    JobSystem jobs;
+
+    enum PoolType : uint8_t {
+        NOT_POOLED,     // made by the caller with new
+        CIRCLE_POOL,
+        POLYGON_POOL,
+        RECTANGLE_POOL,
+        REGULAR_POLYGON_POOL
+    };
+
+    static constexpr uint32_t ALL_PAIRS_CHUNK = 16384;
+    static constexpr uint32_t ROW_GRAIN = 4096;         // bodies per job
+    static constexpr uint32_t PAIR_GRAIN = 2048;        // narrowphase pairs per job
+    static constexpr uint32_t SOLVE_GRAIN = 256;        // manifolds or constraints per job
+    static constexpr uint32_t SWEEP_GRAIN = 16;         // bullets per job
+    static constexpr uint32_t SPECULATIVE_ITERATIONS = 4;   // passes of ContactSolver::limitApproach
+    static constexpr uint32_t LARGE_ISLAND_WORK = 4096; // islands above this are split by coloring
+    static constexpr uint32_t BINS_PER_THREAD = 4;      // jobs of small islands per thread, for balance
+
     void applyGravity() {
-        for (auto &obj : body_list) {
-            if (!obj->isStatic())
-                obj->accelerate(gravity);
+        jobs.parallelFor(store.size(), ROW_GRAIN, [this](uint32_t begin, uint32_t end) {
+            store.applyGravity(gravity.x, gravity.y, begin, end);
+        });
+    }
+
+    [[nodiscard]] bool isActive(uint32_t row) const {
+        return !store.is_static[row] && store.is_awake[row];
+    }
+
+    [[nodiscard]] bool isAsleep(uint32_t row) const {
+        return !store.is_static[row] && !store.is_awake[row];
+    }
+
+    [[nodiscard]] static bool isActive(const Body* body) {
+        return body && !body->isStatic() && body->isAwake();
+    }
+
+    [[nodiscard]] uint32_t rowOf(const Body* body) const {
+        return store.row(body->handle());
+    }
+
+    [[nodiscard]] PoolType poolOf(const Body* body) const {
+        const uint32_t id = body->handle().id;
+        return id < pool_of.size() ? static_cast<PoolType>(pool_of[id]) : NOT_POOLED;
+    }
+
+    template <typename T>
+    T &addPooled(T* body, PoolType pool) {
+        addBody(body);
+        const uint32_t id = body->handle().id;
+        if (pool_of.size() <= id)
+            pool_of.resize(id + 1, NOT_POOLED);
+        pool_of[id] = pool;
+        return *body;
+    }
+
+    // the destructor takes the body's row out of the store, the last row moves into its place
+    void destroyPooled(Body* body) {
+        const PoolType pool = poolOf(body);
+        pool_of[body->handle().id] = NOT_POOLED;
+        switch (pool) {
+            case CIRCLE_POOL:
+                circle_pool.destroy(static_cast<CircleBody*>(body));
+                break;
+            case POLYGON_POOL:
+                polygon_pool.destroy(static_cast<PolygonBody*>(body));
+                break;
+            case RECTANGLE_POOL:
+                rectangle_pool.destroy(static_cast<RectangleBody*>(body));
+                break;
+            case REGULAR_POLYGON_POOL:
+                regular_polygon_pool.destroy(static_cast<RegularPolygonBody*>(body));
+                break;
+            case NOT_POOLED:
+                break;
         }
     }
 
-    void resolveCollisions(float dt) {
-        manifolds.clear();
+    // wakes every body of the sleeping island row belongs to
+    void wakeIsland(uint32_t row) {
+        const uint32_t id = store.island[row];
+        if (id == BodyHandle::NONE) {
+            store.is_awake[row] = 1;
+            store.sleep_time[row] = 0.f;
+            return;
+        }
+
+        for (BodyHandle handle : sleeping_islands[id]) {
+            // removed bodies leave a stale handle behind
+            if (!store.contains(handle) || store.island[store.row(handle)] != id)
+                continue;
+
+            const uint32_t r = store.row(handle);
+            store.is_awake[r] = 1;
+            store.sleep_time[r] = 0.f;
+            store.island[r] = BodyHandle::NONE;
+        }
+        sleeping_islands[id].clear();
+        free_sleeping_islands.push_back(id);
+    }
+
+    // wakes the islands of the sleeping bodies row was paired with last substep, whatever rests on or leans
+    // against it. the pair cache keeps every pair whose boxes overlapped, sleeping and static ones included
+    void wakeNeighbours(uint32_t row) {
+        if (sleeping_islands.size() == free_sleeping_islands.size())
+            return;
+
+        pair_cache.forEachPartner(store.handle(row), [this](BodyHandle partner) {
+            if (store.contains(partner) && isAsleep(store.row(partner)))
+                wakeIsland(store.row(partner));
+        });
+    }
+
+    // moved by hand since the last substep, or static and moving on its own velocity like a platform. whatever
+    // sleeps against it would be left floating or sunk into it
+    [[nodiscard]] bool isDisturbing(uint32_t row) const {
+        return store.is_moved[row] || (store.is_static[row] && (store.velocity_x[row] != 0.f
+            || store.velocity_y[row] != 0.f || store.angular_velocity[row] != 0.f));
+    }
+
+    // wake-on-force: anything pushing a sleeping body since the last substep wakes its island, and so does
+    // moving it by hand. a disturbing body wakes what slept against it where it was, detect then tests it
+    // against the sleeping bodies where it is now
+    void wakeDisturbed() {
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            if (isDisturbing(i))
+                wakeNeighbours(i);
+            if (!isAsleep(i))
+                continue;
+
+            if (store.is_moved[i]
+                || store.force_x[i] != 0.f || store.force_y[i] != 0.f
+                || store.acceleration_x[i] != 0.f || store.acceleration_y[i] != 0.f
+                || store.velocity_x[i] != 0.f || store.velocity_y[i] != 0.f
+                || store.angular_velocity[i] != 0.f || store.angular_acceleration[i] != 0.f)
+                wakeIsland(i);
+        }
+    }
+
+    // wake-on-contact: an awake body touching or chained to a sleeping one wakes its island
+    void wakeTouched() {
+        for (const Manifold &manifold : manifolds) {
+            if (isAsleep(rowOf(manifold.bodyA)))
+                wakeIsland(rowOf(manifold.bodyA));
+            if (isAsleep(rowOf(manifold.bodyB)))
+                wakeIsland(rowOf(manifold.bodyB));
+        }
+
+        for (Constraint* constraint : constraint_list) {
+            auto [a, b] = constraint->bodies();
+            if (!a || !b || isActive(a) == isActive(b))
+                continue;
 
-        for (unsigned int i = 0; i < body_list.size(); i++) {
-            for (unsigned int j = i + 1; j < body_list.size(); j++) {
-                if (body_list[i]->isStatic() && body_list[j]->isStatic())
+            Body* sleeper = isActive(a) ? b : a;
+            if (!sleeper->isStatic() && store.contains(sleeper->handle()))
+                wakeIsland(rowOf(sleeper));
+        }
+    }
+
+    // a free sleeping island to hold count bodies. the one with the least room that still fits them, so the
+    // room a large island left behind stays for the next large one and nothing is allocated once the same
+    // islands have slept before. the roomiest one when none fits, a new one when none is free
+    uint32_t takeSleepingIsland(size_t count) {
+        if (free_sleeping_islands.empty()) {
+            sleeping_islands.emplace_back();
+            return static_cast<uint32_t>(sleeping_islands.size() - 1);
+        }
+
+        auto better = [&](uint32_t a, uint32_t b) {
+            const size_t room_a = sleeping_islands[a].capacity(), room_b = sleeping_islands[b].capacity();
+            if ((room_a >= count) != (room_b >= count))
+                return room_a >= count;
+            return room_a >= count ? room_a < room_b : room_a > room_b;
+        };
+        auto best = std::min_element(free_sleeping_islands.begin(), free_sleeping_islands.end(), better);
+        const uint32_t id = *best;
+        *best = free_sleeping_islands.back();
+        free_sleeping_islands.pop_back();
+        return id;
+    }
+
+    // puts islands whose bodies have all been resting for time_to_sleep to sleep
+    void updateSleep(float dt) {
+        const float linear_sq = sleep_linear_speed * sleep_linear_speed;
+        jobs.parallelFor(store.size(), ROW_GRAIN, [this, dt, linear_sq](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                if (!isActive(i))
                     continue;
 
-                if (body_list[i]->shape() == ShapeType::CIRCLE) {
-                    auto obj1 = dynamic_cast<CircleBody*>(body_list[i]);
+                const float vx = store.velocity_x[i], vy = store.velocity_y[i];
+                const bool resting = vx * vx + vy * vy <= linear_sq
+                    && std::abs(store.angular_velocity[i]) <= sleep_angular_speed;
+                store.sleep_time[i] = resting ? store.sleep_time[i] + dt : 0.f;
+            }
+        });
 
-                    if (body_list[j]->shape() == ShapeType::CIRCLE) {
-                        auto obj2 = dynamic_cast<CircleBody*>(body_list[j]);
+        // islands as solveIslands built them this substep
+        for (uint32_t n = 0; n < islands.count(); ++n) {
+            std::span<const uint32_t> rows = islands.island(n);
+            const bool rested = std::all_of(rows.begin(), rows.end(), [this](uint32_t row) {
+                return store.sleep_time[row] >= time_to_sleep;
+            });
+            if (!rested)
+                continue;
 
-                        Manifold manifold;
-                        if (Collisions::intersectCircles(obj1->position(),
-                                                         obj1->radius(),
-                                                         obj2->position(),
-                                                         obj2->radius(),
-                                                         manifold)) {
-                            float obj1_ratio = obj2->isStatic() ? 1.f : 1.f / (1.f + obj1->mass() / obj2->mass());
-                            float obj2_ratio = obj1->isStatic() ? 1.f : 1.f / (1.f + obj2->mass() / obj1->mass());
+            const uint32_t id = takeSleepingIsland(rows.size());
+            for (uint32_t row : rows) {
+                store.is_awake[row] = 0;
+                store.island[row] = id;
+                store.velocity_x[row] = store.velocity_y[row] = 0.f;
+                store.acceleration_x[row] = store.acceleration_y[row] = 0.f;
+                store.force_x[row] = store.force_y[row] = 0.f;
+                store.angular_velocity[row] = store.angular_acceleration[row] = 0.f;
+                sleeping_islands[id].push_back(store.handle(row));
+            }
+        }
+    }
 
-                            obj1->move(-manifold.normal * obj1_ratio * manifold.depth);
-                            obj2->move(manifold.normal * obj2_ratio * manifold.depth);
+    void wakeAll() {
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            if (isAsleep(i))
+                wakeIsland(i);
+        }
+    }
 
-                            manifold.setBody(obj1, obj2);
-                            manifolds.push_back(manifold);
-                        }
-                    }
-                    else if (body_list[j]->shape() == ShapeType::POLYGON) {
-                        auto obj2 = dynamic_cast<PolygonBody*>(body_list[j]);
-
-                        Manifold manifold;
-                        if (Collisions::intersectCircleAndPolygon(obj1->position(),
-                                                                  obj1->radius(),
-                                                                  obj2->position(),
-                                                                  obj2->vertices(),
-                                                                  manifold)) {
-                            float obj1_ratio = obj2->isStatic() ? 1.f : 1.f / (1.f + obj1->mass() / obj2->mass());
-                            float obj2_ratio = obj1->isStatic() ? 1.f : 1.f / (1.f + obj2->mass() / obj1->mass());
-
-                            obj1->move(-manifold.normal * obj1_ratio * manifold.depth);
-                            obj2->move(manifold.normal * obj2_ratio * manifold.depth);
-
-                            manifold.setBody(obj1, obj2);
-                            manifolds.push_back(manifold);
-                        }
-                    }
+    // polygons build their world vertices lazily, which must not happen from several jobs at once
+    void syncPolygons() {
+        jobs.parallelFor(store.size(), ROW_GRAIN, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                if (store.shape[i] == POLYGON)
+                    static_cast<const PolygonBody*>(store.bodies[i])->syncTransform();
+            }
+        });
+    }
+
+    // sleeping bodies keep whatever velocity they fell asleep with, but do not move
+    [[nodiscard]] Vec2 velocityOf(uint32_t row) const {
+        return isActive(row) ? Vec2{store.velocity_x[row], store.velocity_y[row]} : Vec2{};
+    }
+
+    // the furthest the pair can close in over the substep, from its own velocities
+    [[nodiscard]] float speculativeMargin(uint32_t i, uint32_t j, float dt) const {
+        return speculative ? std::abs(velocityOf(j) - velocityOf(i)) * dt : 0.f;
+    }
+
+    // a speculative contact lets the pair close in by its gap along the normal, from i to j. one that closes
+    // in faster but never meets within the substep is passing by, the contact would only knock it aside.
+    // contacts that close in slower push nothing unless the solver turns a body toward the other
+    [[nodiscard]] bool passesBy(uint32_t i, uint32_t j, Vec2 normal, float gap, float dt) const {
+        const float approach = -((velocityOf(j) - velocityOf(i)) * normal) * dt;
+        return approach > gap
+            && Collisions::timeOfImpact(store.bodies[i], velocityOf(i), store.bodies[j], velocityOf(j), dt, 0.f) >= dt;
+    }
+
+    // tests pairs[begin, end) without touching any body
+    void detect(uint32_t begin, uint32_t end, NarrowphaseChunk &chunk, float dt) const {
+        chunk.circle_first.clear();
+        chunk.circle_second.clear();
+        chunk.circle_pair.clear();
+        chunk.circle_contacts.clear();
+        chunk.other.clear();
+        chunk.other_pair.clear();
+        chunk.manifolds.clear();
+        chunk.kept.clear();
+
+        // circle-circle pairs are deferred to the batched kernel, the rest go through Collisions::collide
+        for (uint32_t k = begin; k < end; ++k) {
+            auto [i, j] = pairs[k];
+            const BodyHandle handle_i = store.handle(i), handle_j = store.handle(j);
+
+            // static and sleeping bodies have nothing to find between themselves, what was known stays known.
+            // a sleeping body does against a disturbing one, the contact wakes it
+            if (!isActive(i) && !isActive(j) && !(isAsleep(i) && isDisturbing(j)) && !(isAsleep(j) && isDisturbing(i))) {
+                if (const PairCache::Entry* cached = pair_cache.find(handle_i, handle_j))
+                    chunk.kept.push_back(*cached);
+                continue;
+            }
+
+            // the all-pairs loop hands over pairs the broadphase would have dropped, those are not worth caching
+            if (store.max_x[i] < store.min_x[j] || store.max_x[j] < store.min_x[i]
+                || store.max_y[i] < store.min_y[j] || store.max_y[j] < store.min_y[i])
+                continue;
+
+            const NarrowphaseType type = narrowphase_types[store.shape[i]][store.shape[j]];
+            if (store.shape[i] == CIRCLE && store.shape[j] == CIRCLE && type == SAT) {
+                chunk.circle_first.push_back(i);
+                chunk.circle_second.push_back(j);
+                chunk.circle_pair.push_back(k);
+                continue;
+            }
+
+            // a pair that was apart usually still is along the same axis
+            const float margin = speculativeMargin(i, j, dt);
+            const PairCache::Entry* cached = pair_cache.find(handle_i, handle_j);
+            if (cached && !cached->touching
+                && Collisions::separatedAlong(store.bodies[i], store.bodies[j], cached->axis, margin)) {
+                chunk.kept.push_back(*cached);
+                continue;
+            }
+
+            Manifold manifold;
+            if (Collisions::collide(store.bodies[i], store.bodies[j], manifold, type)
+                || (margin > 0.f && Collisions::speculate(store.bodies[i], store.bodies[j], margin, manifold)
+                    && !passesBy(i, j, manifold.normal, -manifold.depth, dt))) {
+                manifold.setBody(store.bodies[i], store.bodies[j]);
+                chunk.other.push_back(manifold);
+                chunk.other_pair.push_back(k);
+            }
+            else
+                chunk.kept.push_back(PairCache::Entry::separated(handle_i, handle_j, manifold.normal));
+        }
+
+        CircleBatch::collide(store, chunk.circle_first, chunk.circle_second, chunk.circle_contacts, simd_level,
+                             speculative_margin);
+
+        // both lists are sorted by pair, merge them
+        size_t o = 0;
+        for (const CircleContact &contact : chunk.circle_contacts) {
+            const uint32_t k = chunk.circle_pair[contact.pair];
+            for (; o < chunk.other.size() && chunk.other_pair[o] < k; ++o)
+                chunk.manifolds.push_back(chunk.other[o]);
+
+            const uint32_t i = chunk.circle_first[contact.pair];
+            const uint32_t j = chunk.circle_second[contact.pair];
+            // the batch takes every pair within the margin of the fastest pair
+            if (contact.depth < 0.f && (-contact.depth >= speculativeMargin(i, j, dt)
+                                        || passesBy(i, j, contact.normal, -contact.depth, dt)))
+                continue;
+            chunk.manifolds.emplace_back(store.bodies[i], store.bodies[j], contact.normal, contact.depth,
+                                         store.bodies[i]->position() + contact.normal * store.radius[i], Vec2{}, 1);
+        }
+        chunk.manifolds.insert(chunk.manifolds.end(), chunk.other.begin() + o, chunk.other.end());
+    }
+
+    // detects every pair in parallel, one chunk of pairs per job, and appends the hits to manifolds in pair order
+    void narrowphase(float dt) {
+        const auto count = static_cast<uint32_t>(pairs.size());
+        // chunks only grow, one dropped when the pair count dips would have its buffers allocated again
+        const uint32_t chunk_count = (count + PAIR_GRAIN - 1) / PAIR_GRAIN;
+        if (chunks.size() < chunk_count)
+            chunks.resize(chunk_count);
+        jobs.parallelFor(count, PAIR_GRAIN, [this, dt](uint32_t begin, uint32_t end) {
+            detect(begin, end, chunks[begin / PAIR_GRAIN], dt);
+        });
+
+        for (uint32_t c = 0; c < chunk_count; ++c) {
+            manifolds.insert(manifolds.end(), chunks[c].manifolds.begin(), chunks[c].manifolds.end());
+            kept_pairs.insert(kept_pairs.end(), chunks[c].kept.begin(), chunks[c].kept.end());
+        }
+    }
+
+    // the row coloring has to keep apart, static bodies are only read
+    uint32_t colorRow(const Body* body) const {
+        if (!body || !store.contains(body->handle()) || store.bodies[store.row(body->handle())] != body)
+            return GraphColoring::SERIAL;
+        return body->isStatic() ? GraphColoring::FREE : store.row(body->handle());
+    }
+
+    // runs fn(k) for every item, batch after batch. items of one batch share no body, so they run in parallel
+    // and the result is the same as running the batches one item at a time
+    template <typename F>
+    void solveColored(const GraphColoring &coloring, const F &fn) {
+        for (uint32_t c = 0; c < GraphColoring::batchCount(); ++c) {
+            std::span<const uint32_t> batch = coloring.batch(c);
+            if (GraphColoring::isSerial(c)) {
+                for (uint32_t k : batch)
+                    fn(k);
+                continue;
+            }
+
+            jobs.parallelFor(static_cast<uint32_t>(batch.size()), SOLVE_GRAIN, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t n = begin; n < end; ++n)
+                    fn(batch[n]);
+            });
+        }
+    }
+
+    // grows the box of every awake body by as far as it moves this substep, in every direction since a bounce
+    // within the substep can turn it around, and swaps the grown boxes into the store so both the broadphase
+    // and the narrowphase find the pairs that may meet. no pair closes in faster than twice the top speed,
+    // which bounds the margin of every pair
+    void sweepBounds(float dt) {
+        swept_min_x.resize(store.size());
+        swept_min_y.resize(store.size());
+        swept_max_x.resize(store.size());
+        swept_max_y.resize(store.size());
+
+        float top_speed_sq = 0.f;
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            const float vx = store.velocity_x[i], vy = store.velocity_y[i];
+            const float speed_sq = isActive(i) ? vx * vx + vy * vy : 0.f;
+            const float reach = std::sqrt(speed_sq) * dt;
+            swept_min_x[i] = store.min_x[i] - reach;
+            swept_min_y[i] = store.min_y[i] - reach;
+            swept_max_x[i] = store.max_x[i] + reach;
+            swept_max_y[i] = store.max_y[i] + reach;
+            top_speed_sq = std::max(top_speed_sq, speed_sq);
+        }
+        speculative_margin = 2.f * std::sqrt(top_speed_sq) * dt;
+        swapBounds();
+    }
+
+    void swapBounds() {
+        std::swap(store.min_x, swept_min_x);
+        std::swap(store.min_y, swept_min_y);
+        std::swap(store.max_x, swept_max_x);
+        std::swap(store.max_y, swept_max_y);
+    }
+
+    void resolveCollisions(float dt) {
+        manifolds.clear();
+        kept_pairs.clear();
+        syncPolygons();
+        if (speculative)
+            sweepBounds(dt);
+
+        broadphase_current = broadphase && store.size() >= broadphase_threshold;
+        if (broadphase_current) {
+            broadphase->update(store, pairs);
+            // each pair ends up a manifold, kept, or neither. room for all of them as either, so while the pair
+            // count holds, sleeping islands turning contacts into kept pairs and back allocate nothing
+            manifolds.reserve(pairs.size());
+            kept_pairs.reserve(pairs.size());
+            narrowphase(dt);
+        }
+        else {
+            // every pair, fed to the narrowphase in bounded chunks
+            pairs.clear();
+            for (uint32_t i = 0; i < store.size(); i++) {
+                for (uint32_t j = i + 1; j < store.size(); j++)
+                    pairs.emplace_back(i, j);
+
+                if (pairs.size() >= ALL_PAIRS_CHUNK) {
+                    narrowphase(dt);
+                    pairs.clear();
                 }
-                else if (body_list[i]->shape() == ShapeType::POLYGON) {
-                    auto obj1 = dynamic_cast<PolygonBody*>(body_list[i]);
-
-                    if (body_list[j]->shape() == ShapeType::POLYGON) {
-                        auto obj2 = dynamic_cast<PolygonBody*>(body_list[j]);
-
-                        Manifold manifold;
-                        if (Collisions::intersectPolygons(obj1->position(),
-                                                          obj1->vertices(),
-                                                          obj2->position(),
-                                                          obj2->vertices(),
-                                                          manifold)) {
-                            float obj1_ratio = obj2->isStatic() ? 1.f : 1.f / (1.f + obj1->mass() / obj2->mass());
-                            float obj2_ratio = obj1->isStatic() ? 1.f : 1.f / (1.f + obj2->mass() / obj1->mass());
-
-                            obj1->move(-manifold.normal * obj1_ratio * manifold.depth);
-                            obj2->move(manifold.normal * obj2_ratio * manifold.depth);
-
-                            manifold.setBody(obj1, obj2);
-                            manifolds.push_back(manifold);
-                        }
-                    }
-                    else if (body_list[j]->shape() == ShapeType::CIRCLE) {
-                        auto obj2 = dynamic_cast<CircleBody*>(body_list[j]);
-
-                        Manifold manifold;
-                        if (Collisions::intersectCircleAndPolygon(obj2->position(),
-                                                                  obj2->radius(),
-                                                                  obj1->position(),
-                                                                  obj1->vertices(),
-                                                                  manifold)) {
-                            float obj1_ratio = obj2->isStatic() ? 1.f : 1.f / (1.f + obj1->mass() / obj2->mass());
-                            float obj2_ratio = obj1->isStatic() ? 1.f : 1.f / (1.f + obj2->mass() / obj1->mass());
-
-                            obj2->move(-manifold.normal * obj2_ratio * manifold.depth);
-                            obj1->move(manifold.normal * obj1_ratio * manifold.depth);
-
-                            manifold.setBody(obj2, obj1);
-                            manifolds.push_back(manifold);
-                        }
+            }
+            narrowphase(dt);
+        }
+
+        if (speculative)
+            swapBounds();
+        if (sleeping)
+            wakeTouched();
+    }
+
+    // groups the awake bodies into islands over this substep's contacts and constraints,
+    // and sorts both by island
+    void buildIslands() {
+        // static bodies link nothing, or one floor would join every pile on it into one island
+        auto activeRow = [this](const Body* body) {
+            return isActive(body) ? rowOf(body) : Islands::NONE;
+        };
+        // constraints that do not name their bodies, or name bodies of another solver
+        auto known = [this](const Body* a, const Body* b) {
+            return colorRow(a) != GraphColoring::SERIAL && colorRow(b) != GraphColoring::SERIAL;
+        };
+
+        islands.reset(store.size());
+        for (const Manifold &manifold : manifolds)
+            islands.link(activeRow(manifold.bodyA), activeRow(manifold.bodyB));
+
+        serial_constraints.clear();
+        for (uint32_t k = 0; k < constraint_list.size(); ++k) {
+            auto [a, b] = constraint_list[k]->bodies();
+            if (known(a, b))
+                islands.link(activeRow(a), activeRow(b));
+            else
+                serial_constraints.push_back(k);
+        }
+        islands.build([this](uint32_t row) { return isActive(row); });
+
+        // every manifold has an awake side once wakeTouched ran
+        islands.group(static_cast<uint32_t>(manifolds.size()), [&](uint32_t k) {
+            return isActive(manifolds[k].bodyA) ? rowOf(manifolds[k].bodyA) : activeRow(manifolds[k].bodyB);
+        }, contact_start, island_contacts);
+
+        // constraints between sleeping or static bodies belong to no island and are skipped
+        islands.group(static_cast<uint32_t>(constraint_list.size()), [&](uint32_t k) {
+            auto [a, b] = constraint_list[k]->bodies();
+            if (!known(a, b))
+                return Islands::NONE;
+            return isActive(a) ? rowOf(a) : activeRow(b);
+        }, constraint_start, island_constraints);
+    }
+
+    [[nodiscard]] std::span<const uint32_t> contactsOf(uint32_t island) const {
+        return std::span{island_contacts}.subspan(contact_start[island], contact_start[island + 1] - contact_start[island]);
+    }
+
+    [[nodiscard]] std::span<const uint32_t> constraintsOf(uint32_t island) const {
+        return std::span{island_constraints}.subspan(constraint_start[island],
+                                                     constraint_start[island + 1] - constraint_start[island]);
+    }
+
+    // each point takes the impulses it ended the last substep with, if the same features still make it.
+    // only reads the cache, so islands can do it concurrently
+    void prepareContact(Manifold &manifold, float dt) const {
+        const BodyHandle a = manifold.bodyA->handle();
+        const PairCache::Entry* cached = warm_starting ? pair_cache.find(a, manifold.bodyB->handle()) : nullptr;
+        if (cached && cached->touching && cached->first == a.id) {
+            for (uint32_t n = 0; n < manifold.contact_count; ++n) {
+                ContactPoint &point = manifold.points[n];
+                for (uint32_t c = 0; c < cached->point_count; ++c) {
+                    if (cached->feature[c] == point.feature) {
+                        point.normal_impulse = cached->normal_impulse[c];
+                        point.tangent_impulse = cached->tangent_impulse[c];
                     }
                 }
             }
         }
+        ContactSolver::prepare(manifold, dt);
+    }
+
+    // keeps this substep's manifolds, with their impulses, and separating axes for the next one
+    void updatePairCache() {
+        pair_cache.begin(static_cast<uint32_t>(manifolds.size() + kept_pairs.size()));
+        for (const Manifold &manifold : manifolds)
+            pair_cache.insert(PairCache::Entry::contact(manifold));
+        for (const PairCache::Entry &entry : kept_pairs)
+            pair_cache.insert(entry);
+        pair_cache.end();
+    }
+
+    // the contact velocity iterations, restitution, then the constraint iterations, on one thread
+    void solveIsland(uint32_t island, float dt) {
+        std::span<const uint32_t> contacts = contactsOf(island);
+        // all contacts see the velocities from before any warm start
+        for (uint32_t k : contacts)
+            prepareContact(manifolds[k], dt);
+        for (uint32_t k : contacts)
+            ContactSolver::warmStart(manifolds[k]);
+        for (uint32_t i = velocity_iterations; i--;) {
+            for (uint32_t k : contacts)
+                ContactSolver::solveVelocity(manifolds[k]);
+        }
+        for (uint32_t k : contacts)
+            ContactSolver::applyRestitution(manifolds[k]);
+        for (uint32_t i = speculative ? SPECULATIVE_ITERATIONS : 0; i--;) {
+            for (uint32_t k : contacts)
+                ContactSolver::limitApproach(manifolds[k]);
+        }
+
+        for (uint32_t i = projectionIterations(); i--;) {
+            for (uint32_t k : constraintsOf(island))
+                constraint_list[k]->apply();
+        }
+    }
+
+    // the same steps, with the island split into graph-colored batches that run in parallel
+    void solveLargeIsland(uint32_t island, float dt) {
+        std::span<const uint32_t> contacts = contactsOf(island);
+        std::span<const uint32_t> constraints = constraintsOf(island);
+
+        contact_coloring.build(static_cast<uint32_t>(contacts.size()), store.size(), [&](uint32_t n) {
+            const Manifold &manifold = manifolds[contacts[n]];
+            return std::pair{colorRow(manifold.bodyA), colorRow(manifold.bodyB)};
+        });
+        // preparing writes only the manifold, no coloring needed
+        jobs.parallelFor(static_cast<uint32_t>(contacts.size()), SOLVE_GRAIN, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t n = begin; n < end; ++n)
+                prepareContact(manifolds[contacts[n]], dt);
+        });
+        solveColored(contact_coloring, [&](uint32_t n) { ContactSolver::warmStart(manifolds[contacts[n]]); });
+        for (uint32_t i = velocity_iterations; i--;)
+            solveColored(contact_coloring, [&](uint32_t n) { ContactSolver::solveVelocity(manifolds[contacts[n]]); });
+        solveColored(contact_coloring, [&](uint32_t n) { ContactSolver::applyRestitution(manifolds[contacts[n]]); });
+        for (uint32_t i = speculative ? SPECULATIVE_ITERATIONS : 0; i--;)
+            solveColored(contact_coloring, [&](uint32_t n) { ContactSolver::limitApproach(manifolds[contacts[n]]); });
+
+        constraint_coloring.build(static_cast<uint32_t>(constraints.size()), store.size(), [&](uint32_t n) {
+            auto [a, b] = constraint_list[constraints[n]]->bodies();
+            return std::pair{colorRow(a), colorRow(b)};
+        });
+        for (uint32_t i = projectionIterations(); i--;)
+            solveColored(constraint_coloring, [&](uint32_t n) { constraint_list[constraints[n]]->apply(); });
+    }
+
+    // islands share no body, so each can be solved on its own thread without any coloring.
+    // small islands are packed into jobs largest first, large ones are split by solveLargeIsland
+    void solveIslands(float dt) {
+        buildIslands();
+
+        auto work = [this](uint32_t island) {
+            return (velocity_iterations + 2) * static_cast<uint32_t>(contactsOf(island).size())
+                + projectionIterations() * static_cast<uint32_t>(constraintsOf(island).size());
+        };
+
+        island_order.clear();
+        for (uint32_t n = 0; n < islands.count(); ++n) {
+            if (work(n) > 0)
+                island_order.push_back(n);
+        }
+        // ties by index keep the order of a stable sort, without the buffer std::stable_sort allocates
+        std::sort(island_order.begin(), island_order.end(), [&](uint32_t a, uint32_t b) {
+            return work(a) != work(b) ? work(a) > work(b) : a < b;
+        });
+
+        const auto large = static_cast<uint32_t>(std::partition_point(island_order.begin(), island_order.end(),
+            [&](uint32_t n) { return work(n) > LARGE_ISLAND_WORK; }) - island_order.begin());
+        for (uint32_t n = 0; n < large; ++n)
+            solveLargeIsland(island_order[n], dt);
+
+        // longest processing time first: each island goes to the least loaded job so far
+        const uint32_t small = static_cast<uint32_t>(island_order.size()) - large;
+        const uint32_t bins = std::min(small, jobs.threadCount() * BINS_PER_THREAD);
+        bin_load.assign(bins, 0);
+        bin_of.resize(small);
+        for (uint32_t n = 0; n < small; ++n) {
+            const auto bin = static_cast<uint32_t>(std::min_element(bin_load.begin(), bin_load.end()) - bin_load.begin());
+            bin_load[bin] += work(island_order[large + n]);
+            bin_of[n] = bin;
+        }
+
+        bin_start.assign(bins + 1, 0);
+        for (uint32_t n = 0; n < small; ++n)
+            bin_start[bin_of[n] + 1]++;
+        for (uint32_t b = 1; b <= bins; ++b)
+            bin_start[b] += bin_start[b - 1];
+        bin_islands.resize(small);
+        bin_load.assign(bin_start.begin(), bin_start.end() - 1);     // reused as the fill cursor
+        for (uint32_t n = 0; n < small; ++n)
+            bin_islands[bin_load[bin_of[n]]++] = island_order[large + n];
+
+        jobs.parallelFor(bins, 1, [this, dt](uint32_t begin, uint32_t end) {
+            for (uint32_t b = begin; b < end; ++b) {
+                for (uint32_t n = bin_start[b]; n < bin_start[b + 1]; ++n)
+                    solveIsland(bin_islands[n], dt);
+            }
+        });
+
+        // constraints the islands could not place, after everything else
+        for (uint32_t i = projectionIterations(); i--;) {
+            for (uint32_t k : serial_constraints)
+                constraint_list[k]->apply();
+        }
+    }
+
+    // constraint passes the islands run, none when xpbd runs them after integration instead
+    [[nodiscard]] uint32_t projectionIterations() const {
+        return constraint_solver == POSITION_PROJECTION ? constraint_iterations : 0;
+    }
 
-        for (auto &manifold : manifolds) {
-            Collisions::resolveCollision(manifold);
+    // xpbd on the integrated positions, the constraints in colored batches like a large island. every
+    // awake body's velocity then takes on its correction over dt, so what the constraints took out of
+    // the motion stays out. constraints between static or sleeping bodies are skipped, as in the islands
+    void solveConstraints(float dt) {
+        xpbd_constraints.clear();
+        for (uint32_t k = 0; k < constraint_list.size(); ++k) {
+            auto [a, b] = constraint_list[k]->bodies();
+            if (colorRow(a) == GraphColoring::SERIAL || colorRow(b) == GraphColoring::SERIAL || isActive(a) || isActive(b)) {
+                constraint_list[k]->resetMultipliers();
+                xpbd_constraints.push_back(k);
+            }
         }
+        if (xpbd_constraints.empty())
+            return;
+
+        constraint_coloring.build(static_cast<uint32_t>(xpbd_constraints.size()), store.size(), [&](uint32_t n) {
+            auto [a, b] = constraint_list[xpbd_constraints[n]]->bodies();
+            return std::pair{colorRow(a), colorRow(b)};
+        });
+        uncorrected_x.assign(store.position_x.begin(), store.position_x.end());
+        uncorrected_y.assign(store.position_y.begin(), store.position_y.end());
+        for (uint32_t i = constraint_iterations; i--;)
+            solveColored(constraint_coloring, [&](uint32_t n) { constraint_list[xpbd_constraints[n]]->solve(dt); });
+
+        jobs.parallelFor(store.size(), ROW_GRAIN, [this, dt](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                if (isActive(i)) {
+                    store.velocity_x[i] += (store.position_x[i] - uncorrected_x[i]) / dt;
+                    store.velocity_y[i] += (store.position_y[i] - uncorrected_y[i]) / dt;
+                }
+            }
+        });
     }
 
-    void applyConstraints() {
-        for (uint32_t i = 4; i--;) {
-            for (Constraint *constraint : constraint_list) {
-                constraint->apply();
+    // the current boxes for queryAlongX, as SweepAndPrune keeps them. floors and walls are wide, the query
+    // would have to scan most of the rows to find them
+    void sortAlongX() {
+        sorted_x.clear();
+        static_rows.clear();
+        widest_x = 0.f;
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            if (store.is_static[i]) {
+                static_rows.push_back(i);
+                continue;
             }
+            sorted_x.emplace_back(store.min_x[i], i);
+            widest_x = std::max(widest_x, store.max_x[i] - store.min_x[i]);
+        }
+        std::sort(sorted_x.begin(), sorted_x.end());
+    }
+
+    // the rows whose boxes overlap box. a dynamic one starts on x at most widest_x before it
+    void queryAlongX(const AABB &box, List<uint32_t> &found) const {
+        auto overlaps = [&](uint32_t i) {
+            return store.min_x[i] <= box.max.x && box.min.x <= store.max_x[i]
+                && store.min_y[i] <= box.max.y && box.min.y <= store.max_y[i];
+        };
+
+        auto it = std::lower_bound(sorted_x.begin(), sorted_x.end(), box.min.x - widest_x,
+                                   [](const std::pair<float, uint32_t> &entry, float value) { return entry.first < value; });
+        for (; it != sorted_x.end() && it->first <= box.max.x; ++it) {
+            if (overlaps(it->second))
+                found.push_back(it->second);
+        }
+
+        for (uint32_t i : static_rows) {
+            if (overlaps(i))
+                found.push_back(i);
+        }
+    }
+
+    // the first impact over the substep of every bullet, and of every body faster than bullet_speed, with
+    // whatever its path crosses. runs on the solved velocities, just before the positions follow them
+    void sweepBullets(float dt) {
+        const float speed_sq = bullet_speed * bullet_speed;
+        float top_speed_sq = 0.f;
+        bullet_rows.clear();
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            const float vx = store.velocity_x[i], vy = store.velocity_y[i];
+            if (!isActive(i))
+                continue;
+            if (store.is_bullet[i] || vx * vx + vy * vy > speed_sq)
+                bullet_rows.push_back(i);
+            top_speed_sq = std::max(top_speed_sq, vx * vx + vy * vy);
+        }
+        impact_times.resize(bullet_rows.size());
+        if (bullet_rows.empty())
+            return;
+
+        // constraints may have moved bodies since the narrowphase
+        syncPolygons();
+
+        // the broadphase has this substep's boxes, unless position projection moved bodies since it was updated.
+        // then, and without one, the boxes are sorted along x here. each bullet's box is swept over the substep
+        // and grown by as far as anything else moves, so every body whose path can meet the bullet's comes up
+        const bool current = broadphase_current && (projectionIterations() == 0 || constraint_list.empty());
+        if (!current)
+            sortAlongX();
+
+        const float reach = std::sqrt(top_speed_sq) * dt;
+        candidate_start.clear();
+        candidates.clear();
+        for (uint32_t i : bullet_rows) {
+            const auto begin = static_cast<uint32_t>(candidates.size());
+            const Vec2 motion{store.velocity_x[i] * dt, store.velocity_y[i] * dt};
+            const AABB swept{{store.min_x[i] + std::min(motion.x, 0.f), store.min_y[i] + std::min(motion.y, 0.f)},
+                             {store.max_x[i] + std::max(motion.x, 0.f), store.max_y[i] + std::max(motion.y, 0.f)}};
+            if (current)
+                broadphase->query(swept.expanded(reach), candidates);
+            else
+                queryAlongX(swept.expanded(reach), candidates);
+
+            std::sort(candidates.begin() + begin, candidates.end());
+            candidates.erase(std::unique(candidates.begin() + begin, candidates.end()), candidates.end());
+            candidate_start.push_back(begin);
         }
+        candidate_start.push_back(static_cast<uint32_t>(candidates.size()));
+
+        jobs.parallelFor(static_cast<uint32_t>(bullet_rows.size()), SWEEP_GRAIN, [this, dt](uint32_t begin, uint32_t end) {
+            for (uint32_t n = begin; n < end; ++n) {
+                const uint32_t i = bullet_rows[n];
+                const Vec2 velocity_i{store.velocity_x[i], store.velocity_y[i]};
+                const Vec2 motion_i = velocity_i * dt;
+                float first = std::numeric_limits<float>::infinity();
+
+                auto sweep = [&](uint32_t j) {
+                    const Vec2 velocity_j = velocityOf(j);
+                    const Vec2 motion_j = velocity_j * dt;
+                    // the boxes swept over the substep
+                    if (j == i
+                        || store.max_x[i] + std::max(motion_i.x, 0.f) < store.min_x[j] + std::min(motion_j.x, 0.f)
+                        || store.max_x[j] + std::max(motion_j.x, 0.f) < store.min_x[i] + std::min(motion_i.x, 0.f)
+                        || store.max_y[i] + std::max(motion_i.y, 0.f) < store.min_y[j] + std::min(motion_j.y, 0.f)
+                        || store.max_y[j] + std::max(motion_j.y, 0.f) < store.min_y[i] + std::min(motion_i.y, 0.f))
+                        return;
+
+                    // into it no deeper than the contact solver leaves alone
+                    first = std::min(first, Collisions::timeOfImpact(store.bodies[i], velocity_i, store.bodies[j],
+                                                                      velocity_j, dt, ContactSolver::SLOP));
+                };
+
+                for (uint32_t k = candidate_start[n]; k < candidate_start[n + 1]; ++k)
+                    sweep(candidates[k]);
+                impact_times[n] = first;
+            }
+        });
     }
 
-    void updateBodies(float dt) {
-        for (auto &obj : body_list) {
-            obj->update(dt);
+    // takes back the part of the substep a bullet would have moved past its impact. the contact
+    // is then found and solved next substep
+    void stopBullets(float dt) {
+        for (uint32_t n = 0; n < bullet_rows.size(); ++n) {
+            if (impact_times[n] < dt) {
+                Body* body = store.bodies[bullet_rows[n]];
+                body->move(-body->velocity() * (dt - impact_times[n]));
+            }
         }
     }
 
+    void integrateVelocities(float dt) {
+        jobs.parallelFor(store.size(), ROW_GRAIN, [this, dt](uint32_t begin, uint32_t end) {
+            store.integrateVelocity(dt, begin, end);
+        });
+    }
+
+    void integratePositions(float dt) {
+        jobs.parallelFor(store.size(), ROW_GRAIN, [this, dt](uint32_t begin, uint32_t end) {
+            store.integratePosition(dt, begin, end);
+        });
+    }
+
  public:
     Solver() = default;
     explicit Solver(Vec2 gravity, uint32_t sub_steps = 1, uint32_t fps = 120): gravity{gravity}, sub_steps{sub_steps}, frame_dt{1.0f / static_cast<float>(fps)} {}
+    ~Solver() {
+        // bodies outlive the solver and take their state back. pooled ones go with it
+        wakeAll();
+        while (store.size() > 0) {
+            Body* body = store.bodies.back();
+            if (poolOf(body) != NOT_POOLED)
+                destroyPooled(body);
+            else
+                store.detach(body);
+        }
+    }
 
     void update() {
         time += frame_dt;
         const float step_dt = getStepDt();
 
         for (unsigned int i = sub_steps; i--;) {
+            if (sleeping)
+                wakeDisturbed();
             applyGravity();
             resolveCollisions(step_dt);
-            applyConstraints();
-            updateBodies(step_dt);
+            // the contacts are solved on the new velocities, and the positions follow the solved ones
+            integrateVelocities(step_dt);
+            solveIslands(step_dt);
+            sweepBullets(step_dt);
+            integratePositions(step_dt);
+            stopBullets(step_dt);
+            if (constraint_solver == XPBD)
+                solveConstraints(step_dt);
+            updatePairCache();
+            if (sleeping)
+                updateSleep(step_dt);
+            // what the step itself moved is no disturbance
+            std::fill(store.is_moved.begin(), store.is_moved.end(), 0);
         }
     }
 
@@ -165,6 +949,175 @@ class Solver {
         this->sub_steps = steps;
     }
 
+    // sequential impulse passes over the contacts per substep, taller stacks need more of them to settle
+    void setVelocityIterations(uint32_t iterations) {
+        velocity_iterations = iterations;
+    }
+
+    [[nodiscard]]
+    uint32_t getVelocityIterations() const {
+        return velocity_iterations;
+    }
+
+    // passes over the constraints per substep, in either constraint solver
+    void setConstraintIterations(uint32_t iterations) {
+        constraint_iterations = iterations;
+    }
+
+    [[nodiscard]]
+    uint32_t getConstraintIterations() const {
+        return constraint_iterations;
+    }
+
+    // POSITION_PROJECTION, the default, pulls bodies together between the velocity iterations and
+    // integration, leaving their velocities as they were. XPBD weighs the corrections by the inverse
+    // masses and each constraint's compliance and carries them into the velocities, long chains then
+    // hold their length at one or two substeps
+    void setConstraintSolver(ConstraintSolverType type) {
+        constraint_solver = type;
+    }
+
+    [[nodiscard]]
+    ConstraintSolverType getConstraintSolver() const {
+        return constraint_solver;
+    }
+
+    // starts every persisting contact from the impulse it ended the last substep with
+    void setWarmStarting(bool enabled) {
+        warm_starting = enabled;
+    }
+
+    [[nodiscard]]
+    bool getWarmStarting() const {
+        return warm_starting;
+    }
+
+    void setBroadphase(BroadphaseType type) {
+        broadphase_type = type;
+        broadphase_current = false;
+        switch (type) {
+            case UNIFORM_GRID:
+                broadphase = std::make_unique<UniformGrid>();
+                break;
+            case SWEEP_AND_PRUNE:
+                broadphase = std::make_unique<SweepAndPrune>();
+                break;
+            case AABB_TREE:
+                broadphase = std::make_unique<TreeBroadphase>();
+                break;
+            default:
+                broadphase.reset();
+                break;
+        }
+
+        if (broadphase)
+            broadphase->setJobSystem(&jobs);
+    }
+
+    [[nodiscard]]
+    BroadphaseType getBroadphase() const {
+        return broadphase_type;
+    }
+
+    // scenes with fewer bodies than this keep using the all-pairs loop
+    void setBroadphaseThreshold(uint32_t count) {
+        broadphase_threshold = count;
+    }
+
+    // islands of bodies resting for a while stop being integrated and collision tested until something
+    // touches them, pushes them, or moves or removes a body they rest on
+    void setSleeping(bool enabled) {
+        sleeping = enabled;
+        if (!enabled)
+            wakeAll();
+    }
+
+    [[nodiscard]]
+    bool getSleeping() const {
+        return sleeping;
+    }
+
+    void setSleepThresholds(float linear_speed, float angular_speed) {
+        sleep_linear_speed = linear_speed;
+        sleep_angular_speed = angular_speed;
+    }
+
+    void setTimeToSleep(float seconds) {
+        time_to_sleep = seconds;
+    }
+
+    [[nodiscard]]
+    uint64_t getAwakeBodyCount() const {
+        uint64_t count = 0;
+        for (uint32_t i = 0; i < store.size(); ++i)
+            count += isActive(i);
+        return count;
+    }
+
+    [[nodiscard]]
+    uint64_t getSleepingBodyCount() const {
+        uint64_t count = 0;
+        for (uint32_t i = 0; i < store.size(); ++i)
+            count += isAsleep(i);
+        return count;
+    }
+
+    // 0 = one per hardware thread, 1 = everything on the calling thread
+    void setThreadCount(uint32_t count) {
+        jobs.setThreadCount(count);
+    }
+
+    [[nodiscard]]
+    uint32_t getThreadCount() const {
+        return jobs.threadCount();
+    }
+
+    // the circle-circle kernel, defaults to the widest one the cpu supports
+    void setSimdLevel(SimdLevel level) {
+        simd_level = Simd::supported(level) ? level : Simd::best();
+    }
+
+    [[nodiscard]]
+    SimdLevel getSimdLevel() const {
+        return simd_level;
+    }
+
+    // how pairs of these two shapes are tested, in either order. GJK_EPA pays off for polygons with many
+    // vertices, circle pairs only leave the batched kernel for it
+    void setNarrowphase(ShapeType a, ShapeType b, NarrowphaseType type) {
+        narrowphase_types[a][b] = narrowphase_types[b][a] = type;
+    }
+
+    [[nodiscard]]
+    NarrowphaseType getNarrowphase(ShapeType a, ShapeType b) const {
+        return narrowphase_types[a][b];
+    }
+
+    // contacts for pairs that are still apart but may meet within the substep, with a negative depth. the
+    // solver only takes out the part of their approach that would close the gap, so fast bodies stop at
+    // what they hit without more substeps. cheaper than bullets, but a bounce can start a little early. each
+    // pair's margin is as far as it closes in over the substep, and a pair that would only pass by gets none
+    void setSpeculativeContacts(bool enabled) {
+        speculative = enabled;
+        speculative_margin = 0.f;
+    }
+
+    [[nodiscard]]
+    bool getSpeculativeContacts() const {
+        return speculative;
+    }
+
+    // bodies moving faster than this, in px/s, are stopped at whatever they would pass through within a
+    // substep, like bullets. infinity, the default, leaves it to Body::setBullet
+    void setBulletSpeed(float speed) {
+        bullet_speed = speed;
+    }
+
+    [[nodiscard]]
+    float getBulletSpeed() const {
+        return bullet_speed;
+    }
+
     [[nodiscard]]
     float getTime() const {
         return time;
@@ -177,7 +1130,12 @@ class Solver {
 
     [[nodiscard]]
     const List<Body*> &getBodyList() const {
-        return body_list;
+        return store.bodies;
+    }
+
+    [[nodiscard]]
+    const BodyStore &getBodyStore() const {
+        return store;
     }
 
     [[nodiscard]]
@@ -192,7 +1150,7 @@ class Solver {
 
     [[nodiscard]]
     uint64_t getBodyCount() const {
-        return body_list.size();
+        return store.size();
     }
 
     [[nodiscard]]
@@ -201,21 +1159,62 @@ class Solver {
     }
 
     Body& addBody(Body* obj) {
-        body_list.push_back(obj);
+        store.adopt(obj);
+
+        // whatever island it slept in belonged to another solver
+        const uint32_t row = rowOf(obj);
+        store.is_awake[row] = 1;
+        store.sleep_time[row] = 0.f;
+        store.island[row] = BodyHandle::NONE;
+        // its handle id may have been a pooled body's
+        if (obj->handle().id < pool_of.size())
+            pool_of[obj->handle().id] = NOT_POOLED;
         return *obj;
     }
 
+    // bodies made in the solver's pools, one per body type: slabs that are never moved, and a removed body's
+    // memory goes to the next body of its type instead of back to the heap. removeBody destroys them, so
+    // nothing may keep a pointer to one past its removal, constraints included. they stay in this solver
+    CircleBody &createCircle(Vec2 position, float radius, Material material) {
+        return addPooled(circle_pool.create(position, radius, material), CIRCLE_POOL);
+    }
+
+    PolygonBody &createPolygon(Vec2 position, List<Vec2> vertices, Material material) {
+        return addPooled(polygon_pool.create(position, std::move(vertices), material), POLYGON_POOL);
+    }
+
+    RectangleBody &createRectangle(Vec2 position, float width, float height, Material material) {
+        return addPooled(rectangle_pool.create(position, width, height, material), RECTANGLE_POOL);
+    }
+
+    RegularPolygonBody &createRegularPolygon(Vec2 position, float radius, uint64_t sides, Material material) {
+        return addPooled(regular_polygon_pool.create(position, radius, sides, material), REGULAR_POLYGON_POOL);
+    }
+
+    // the last body takes the place of the removed one. whatever rested on it wakes up. a pooled body is
+    // destroyed, any other goes back to its owner
     bool removeBody(Body* obj) {
-        auto it = std::find(body_list.begin(), body_list.end(), obj);
-        if (it != body_list.end()) {
-            body_list.erase(it);
-            return true;
-        }
-        return false;
+        BodyHandle handle = obj->handle();
+        if (!store.contains(handle) || store.bodies[store.row(handle)] != obj)
+            return false;
+
+        if (isAsleep(store.row(handle)))
+            wakeIsland(store.row(handle));
+        wakeNeighbours(store.row(handle));
+        if (poolOf(obj) != NOT_POOLED)
+            destroyPooled(obj);
+        else
+            store.detach(obj);
+        return true;
     }
 
     Body* getBody(uint32_t index) {
-        return body_list[index];
+        return store.bodies[index];
+    }
+
+    // nullptr once the body is gone, even if its handle id has been given to another body since
+    Body* getBody(BodyHandle handle) {
+        return store.contains(handle) ? store.bodies[store.row(handle)] : nullptr;
     }
 
     void addConstraint(Constraint* constraint) {
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../../engine/common/AABB.hpp"
+#include "../../engine/common/Body.hpp"
+
+// dynamic bounding volume tree. leaves hold fat boxes, internal nodes are kept balanced with rotations.
+class AABBTree {
+ public:
+    static constexpr int32_t NONE = -1;
+
+ private:
+    struct Node {
+        AABB box;
+        int32_t parent = NONE;   // next free node while on the free list
+        int32_t left = NONE;
+        int32_t right = NONE;
+        int32_t height = 0;
+        uint32_t body = 0;
+
+        [[nodiscard]] bool isLeaf() const {
+            return left == NONE;
+        }
+    };
+
+    List<Node> nodes;
+    int32_t root = NONE;
+    int32_t free_list = NONE;
+    List<int32_t> stack;
+
+    int32_t allocate() {
+        if (free_list == NONE) {
+            nodes.emplace_back();
+            return static_cast<int32_t>(nodes.size() - 1);
+        }
+
+        int32_t index = free_list;
+        free_list = nodes[index].parent;
+        nodes[index] = Node{};
+        return index;
+    }
+
+    void release(int32_t index) {
+        nodes[index].parent = free_list;
+        nodes[index].height = -1;
+        free_list = index;
+    }
+
+    void refit(int32_t index) {
+        Node &node = nodes[index];
+        node.height = 1 + std::max(nodes[node.left].height, nodes[node.right].height);
+        node.box = nodes[node.left].box.merged(nodes[node.right].box);
+    }
+
+    void replaceChild(int32_t parent, int32_t old_child, int32_t new_child) {
+        if (parent == NONE)
+            root = new_child;
+        else if (nodes[parent].left == old_child)
+            nodes[parent].left = new_child;
+        else
+            nodes[parent].right = new_child;
+    }
+
+    // rotates the taller child of a up if the subtree is unbalanced, returns the new subtree root
+    int32_t balance(int32_t a) {
+        if (nodes[a].isLeaf() || nodes[a].height < 2)
+            return a;
+
+        int32_t b = nodes[a].left;
+        int32_t c = nodes[a].right;
+        int32_t diff = nodes[c].height - nodes[b].height;
+
+        if (diff > 1) {
+            int32_t f = nodes[c].left;
+            int32_t g = nodes[c].right;
+
+            nodes[c].left = a;
+            nodes[c].parent = nodes[a].parent;
+            nodes[a].parent = c;
+            replaceChild(nodes[c].parent, a, c);
+
+            if (nodes[f].height > nodes[g].height) {
+                nodes[c].right = f;
+                nodes[a].right = g;
+                nodes[g].parent = a;
+            }
+            else {
+                nodes[c].right = g;
+                nodes[a].right = f;
+                nodes[f].parent = a;
+            }
+            refit(a);
+            refit(c);
+            return c;
+        }
+
+        if (diff < -1) {
+            int32_t d = nodes[b].left;
+            int32_t e = nodes[b].right;
+
+            nodes[b].left = a;
+            nodes[b].parent = nodes[a].parent;
+            nodes[a].parent = b;
+            replaceChild(nodes[b].parent, a, b);
+
+            if (nodes[d].height > nodes[e].height) {
+                nodes[b].right = d;
+                nodes[a].left = e;
+                nodes[e].parent = a;
+            }
+            else {
+                nodes[b].right = e;
+                nodes[a].left = d;
+                nodes[d].parent = a;
+            }
+            refit(a);
+            refit(b);
+            return b;
+        }
+
+        return a;
+    }
+
+    void walkUp(int32_t index) {
+        while (index != NONE) {
+            index = balance(index);
+            refit(index);
+            index = nodes[index].parent;
+        }
+    }
+
+    void insertLeaf(int32_t leaf) {
+        if (root == NONE) {
+            root = leaf;
+            nodes[leaf].parent = NONE;
+            return;
+        }
+
+        // descend towards the sibling with the smallest perimeter growth
+        const AABB box = nodes[leaf].box;
+        int32_t index = root;
+        while (!nodes[index].isLeaf()) {
+            const Node &node = nodes[index];
+            float combined = node.box.merged(box).perimeter();
+            float cost = 2.f * combined;
+            float inheritance = 2.f * (combined - node.box.perimeter());
+
+            auto descendCost = [&](int32_t child) {
+                float grown = nodes[child].box.merged(box).perimeter();
+                if (nodes[child].isLeaf())
+                    return grown + inheritance;
+                return grown - nodes[child].box.perimeter() + inheritance;
+            };
+
+            float cost_left = descendCost(node.left);
+            float cost_right = descendCost(node.right);
+            if (cost < cost_left && cost < cost_right)
+                break;
+
+            index = cost_left < cost_right ? node.left : node.right;
+        }
+
+        int32_t sibling = index;
+        int32_t old_parent = nodes[sibling].parent;
+        int32_t new_parent = allocate();
+
+        nodes[new_parent].parent = old_parent;
+        nodes[new_parent].left = sibling;
+        nodes[new_parent].right = leaf;
+        nodes[sibling].parent = new_parent;
+        nodes[leaf].parent = new_parent;
+        replaceChild(old_parent, sibling, new_parent);
+
+        walkUp(new_parent);
+    }
+
+    void removeLeaf(int32_t leaf) {
+        if (leaf == root) {
+            root = NONE;
+            return;
+        }
+
+        int32_t parent = nodes[leaf].parent;
+        int32_t grand_parent = nodes[parent].parent;
+        int32_t sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+        nodes[sibling].parent = grand_parent;
+        replaceChild(grand_parent, parent, sibling);
+        release(parent);
+
+        walkUp(grand_parent);
+    }
+
+ public:
+    int32_t insert(const AABB &box, uint32_t body) {
+        int32_t leaf = allocate();
+        nodes[leaf].box = box;
+        nodes[leaf].body = body;
+        insertLeaf(leaf);
+        return leaf;
+    }
+
+    void remove(int32_t leaf) {
+        removeLeaf(leaf);
+        release(leaf);
+    }
+
+    // reinserts the leaf only when the tight box has left its fat box. returns true if it moved.
+    bool move(int32_t leaf, const AABB &tight, float margin) {
+        if (nodes[leaf].box.contains(tight))
+            return false;
+
+        removeLeaf(leaf);
+        nodes[leaf].box = tight.expanded(margin);
+        insertLeaf(leaf);
+        return true;
+    }
+
+    void setBody(int32_t leaf, uint32_t body) {
+        nodes[leaf].body = body;
+    }
+
+    [[nodiscard]] const AABB &box(int32_t leaf) const {
+        return nodes[leaf].box;
+    }
+
+    [[nodiscard]] int32_t height() const {
+        return root == NONE ? 0 : nodes[root].height;
+    }
+
+    void clear() {
+        nodes.clear();
+        root = NONE;
+        free_list = NONE;
+    }
+
+    // calls callback(body) for every leaf whose fat box overlaps box
+    template <typename F>
+    void query(const AABB &box, F &&callback) {
+        if (root == NONE)
+            return;
+
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int32_t index = stack.back();
+            stack.pop_back();
+
+            const Node &node = nodes[index];
+            if (!node.box.overlaps(box))
+                continue;
+
+            if (node.isLeaf()) {
+                callback(node.body);
+            }
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+};
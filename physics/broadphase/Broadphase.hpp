@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "../../engine/common/Body.hpp"
+#include "../../utils/job_system.hpp"
+
+// rows of the solver's body store, first < second
+using BodyPair = std::pair<uint32_t, uint32_t>;
+
+enum BroadphaseType {
+    ALL_PAIRS,
+    UNIFORM_GRID,
+    SWEEP_AND_PRUNE,
+    AABB_TREE
+};
+
+class Broadphase {
+ protected:
+    JobSystem* jobs = nullptr;
+
+    // same chunks as JobSystem::parallelFor, run in order when there is no job system
+    template <typename F>
+    void parallelFor(uint32_t count, uint32_t grain, const F &fn) {
+        if (jobs) {
+            jobs->parallelFor(count, grain, fn);
+            return;
+        }
+        for (uint32_t begin = 0; begin < count; begin += grain)
+            fn(begin, std::min(count, begin + grain));
+    }
+
+ public:
+    virtual ~Broadphase() = default;
+
+    void setJobSystem(JobSystem* job_system) {
+        jobs = job_system;
+    }
+
+    // fills pairs with every pair whose bounds overlap, sorted, static-static pairs excluded
+    virtual void update(const BodyStore &store, List<BodyPair> &pairs) = 0;
+
+    // appends every row whose bounds, as the last update saw them, may overlap box. some may not, and a row
+    // can come up more than once. only valid until the store's rows change
+    virtual void query(const AABB &box, List<uint32_t> &found) = 0;
+
+    static AABB box(const BodyStore &store, uint32_t row) {
+        return {{store.min_x[row], store.min_y[row]}, {store.max_x[row], store.max_y[row]}};
+    }
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+
+#include "Broadphase.hpp"
+
+// sweep and prune over endpoint lists that are kept sorted between updates.
+// bodies move little per substep, so insertion sort repairs the lists in close to linear time.
+class SweepAndPrune : public Broadphase {
+ private:
+    struct Endpoint {
+        float value;
+        uint32_t body;
+        bool is_max;
+
+        bool operator<(const Endpoint &other) const {
+            if (value != other.value)
+                return value < other.value;
+            return !is_max && other.is_max;  // touching boxes still overlap
+        }
+    };
+
+    List<Body*> tracked;
+    List<AABB> boxes;
+    List<Endpoint> axis_x;
+    List<Endpoint> axis_y;
+    List<uint32_t> active;
+    List<uint32_t> active_index;
+    List<uint32_t> static_rows;     // for query, checked one by one
+    float widest = 0.f;             // widest dynamic box along x
+
+    static void insertionSort(List<Endpoint> &axis) {
+        for (size_t i = 1; i < axis.size(); ++i) {
+            Endpoint key = axis[i];
+            size_t j = i;
+            while (j > 0 && key < axis[j - 1]) {
+                axis[j] = axis[j - 1];
+                j--;
+            }
+            axis[j] = key;
+        }
+    }
+
+    void rebuild(const BodyStore &store) {
+        tracked = store.bodies;
+        axis_x.clear();
+        axis_y.clear();
+
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            axis_x.push_back({boxes[i].min.x, i, false});
+            axis_x.push_back({boxes[i].max.x, i, true});
+            axis_y.push_back({boxes[i].min.y, i, false});
+            axis_y.push_back({boxes[i].max.y, i, true});
+        }
+
+        std::sort(axis_x.begin(), axis_x.end());
+        std::sort(axis_y.begin(), axis_y.end());
+    }
+
+    void refresh(List<Endpoint> &axis, bool is_x) {
+        for (auto &endpoint : axis) {
+            const AABB &box = boxes[endpoint.body];
+            if (is_x)
+                endpoint.value = endpoint.is_max ? box.max.x : box.min.x;
+            else
+                endpoint.value = endpoint.is_max ? box.max.y : box.min.y;
+        }
+        insertionSort(axis);
+    }
+
+    void sweep(const BodyStore &store, const List<Endpoint> &axis, List<BodyPair> &pairs) {
+        active.clear();
+        active_index.resize(store.size());
+
+        for (const auto &endpoint : axis) {
+            const uint32_t i = endpoint.body;
+
+            if (endpoint.is_max) {
+                uint32_t index = active_index[i];
+                active[index] = active.back();
+                active_index[active[index]] = index;
+                active.pop_back();
+                continue;
+            }
+
+            for (uint32_t j : active) {
+                if (store.is_static[i] && store.is_static[j])
+                    continue;
+                if (boxes[i].overlaps(boxes[j]))
+                    pairs.emplace_back(std::min(i, j), std::max(i, j));
+            }
+
+            active_index[i] = static_cast<uint32_t>(active.size());
+            active.push_back(i);
+        }
+    }
+
+ public:
+    void update(const BodyStore &store, List<BodyPair> &pairs) override {
+        pairs.clear();
+
+        boxes.resize(store.size());
+        for (uint32_t i = 0; i < store.size(); ++i)
+            boxes[i] = box(store, i);
+
+        if (store.bodies != tracked) {
+            rebuild(store);
+        }
+        else {
+            refresh(axis_x, true);
+            refresh(axis_y, false);
+        }
+
+        // sweep along the axis on which the bodies are spread the most
+        float mean_x = 0.f, mean_y = 0.f, var_x = 0.f, var_y = 0.f;
+        for (const auto &box : boxes) {
+            mean_x += box.min.x + box.max.x;
+            mean_y += box.min.y + box.max.y;
+        }
+        mean_x /= 2.f * static_cast<float>(std::max<size_t>(boxes.size(), 1));
+        mean_y /= 2.f * static_cast<float>(std::max<size_t>(boxes.size(), 1));
+        for (const auto &box : boxes) {
+            float dx = (box.min.x + box.max.x) / 2.f - mean_x;
+            float dy = (box.min.y + box.max.y) / 2.f - mean_y;
+            var_x += dx * dx;
+            var_y += dy * dy;
+        }
+
+        sweep(store, var_x >= var_y ? axis_x : axis_y, pairs);
+
+        std::sort(pairs.begin(), pairs.end());
+
+        // floors and walls are wide, query would have to scan most of the axis to find them
+        static_rows.clear();
+        widest = 0.f;
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            if (store.is_static[i])
+                static_rows.push_back(i);
+            else
+                widest = std::max(widest, boxes[i].max.x - boxes[i].min.x);
+        }
+    }
+
+    // a dynamic box overlapping box starts on x at most widest before it
+    void query(const AABB &box, List<uint32_t> &found) override {
+        auto it = std::lower_bound(axis_x.begin(), axis_x.end(), box.min.x - widest,
+                                   [](const Endpoint &endpoint, float value) { return endpoint.value < value; });
+        for (; it != axis_x.end() && it->value <= box.max.x; ++it) {
+            if (!it->is_max && boxes[it->body].overlaps(box))
+                found.push_back(it->body);
+        }
+
+        for (uint32_t i : static_rows) {
+            if (boxes[i].overlaps(box))
+                found.push_back(i);
+        }
+    }
+};
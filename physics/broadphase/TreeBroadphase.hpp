@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+
+#include "Broadphase.hpp"
+#include "AABBTree.hpp"
+
+// static and dynamic bodies live in separate AABB trees. static leaves are never touched
+// unless the body moves, and the static tree is only visited by queries from dynamic bodies.
+class TreeBroadphase : public Broadphase {
+ private:
+    struct Proxy {
+        int32_t leaf = AABBTree::NONE;
+        bool is_static = false;
+    };
+
+    AABBTree static_tree;
+    AABBTree dynamic_tree;
+    List<Body*> tracked;
+    List<Proxy> proxies;
+    List<AABB> boxes;     // tight boxes, parallel to tracked
+    // scratch of reconcile
+    List<std::pair<Body*, uint32_t>> previous;
+    List<uint8_t> matched;
+    List<Proxy> new_proxies;
+    List<AABB> new_boxes;
+    float margin_ratio = 0.1f;
+
+    float margin(const AABB &box) const {
+        Vec2 size = box.size();
+        return std::max(2.f, margin_ratio * std::max(size.x, size.y));
+    }
+
+    AABBTree &treeOf(const Proxy &proxy) {
+        return proxy.is_static ? static_tree : dynamic_tree;
+    }
+
+    void insertProxy(const BodyStore &store, uint32_t index, Proxy &proxy, AABB &tight) {
+        tight = box(store, index);
+        proxy.is_static = store.is_static[index];
+        proxy.leaf = treeOf(proxy).insert(proxy.is_static ? tight : tight.expanded(margin(tight)), index);
+    }
+
+    // matches proxies to the new body list after bodies were added or removed. the lookup is a sorted list
+    // and the new lists are swapped in, so bodies coming and going reuse the same buffers
+    void reconcile(const BodyStore &store) {
+        const List<Body*> &bodies = store.bodies;
+        previous.clear();
+        for (uint32_t i = 0; i < tracked.size(); ++i)
+            previous.emplace_back(tracked[i], i);
+        std::sort(previous.begin(), previous.end());
+        matched.assign(tracked.size(), 0);
+
+        new_proxies.assign(bodies.size(), Proxy{});
+        new_boxes.assign(bodies.size(), AABB{});
+        for (uint32_t i = 0; i < bodies.size(); ++i) {
+            auto it = std::lower_bound(previous.begin(), previous.end(), std::pair{bodies[i], 0u});
+            if (it == previous.end() || it->first != bodies[i])
+                continue;
+
+            new_proxies[i] = proxies[it->second];
+            new_boxes[i] = boxes[it->second];
+            treeOf(new_proxies[i]).setBody(new_proxies[i].leaf, i);
+            matched[it->second] = 1;
+        }
+
+        for (uint32_t index = 0; index < tracked.size(); ++index) {
+            if (!matched[index])
+                treeOf(proxies[index]).remove(proxies[index].leaf);
+        }
+
+        for (uint32_t i = 0; i < bodies.size(); ++i) {
+            if (new_proxies[i].leaf == AABBTree::NONE)
+                insertProxy(store, i, new_proxies[i], new_boxes[i]);
+        }
+
+        tracked = bodies;
+        std::swap(proxies, new_proxies);
+        std::swap(boxes, new_boxes);
+    }
+
+ public:
+    void setMarginRatio(float ratio) {
+        margin_ratio = ratio;
+    }
+
+    void update(const BodyStore &store, List<BodyPair> &pairs) override {
+        pairs.clear();
+
+        if (store.bodies != tracked)
+            reconcile(store);
+
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            Proxy &proxy = proxies[i];
+
+            if (proxy.is_static != static_cast<bool>(store.is_static[i])) {
+                treeOf(proxy).remove(proxy.leaf);
+                insertProxy(store, i, proxy, boxes[i]);
+                continue;
+            }
+
+            const AABB tight = box(store, i);
+            if (proxy.is_static) {
+                if (tight.min == boxes[i].min && tight.max == boxes[i].max)
+                    continue;
+
+                boxes[i] = tight;
+                static_tree.move(proxy.leaf, boxes[i], 0.f);
+                continue;
+            }
+
+            boxes[i] = tight;
+            dynamic_tree.move(proxy.leaf, boxes[i], margin(boxes[i]));
+        }
+
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            if (proxies[i].is_static)
+                continue;
+
+            const AABB &box = boxes[i];
+            dynamic_tree.query(box, [&](uint32_t j) {
+                if (i < j && box.overlaps(boxes[j]))
+                    pairs.emplace_back(i, j);
+            });
+            static_tree.query(box, [&](uint32_t j) {
+                if (box.overlaps(boxes[j]))
+                    pairs.emplace_back(std::min(i, j), std::max(i, j));
+            });
+        }
+
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    void query(const AABB &box, List<uint32_t> &found) override {
+        dynamic_tree.query(box, [&](uint32_t j) { found.push_back(j); });
+        static_tree.query(box, [&](uint32_t j) { found.push_back(j); });
+    }
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include "Broadphase.hpp"
+
+// spatial hash over a uniform grid, rebuilt from scratch every substep
+class UniformGrid : public Broadphase {
+ private:
+    struct Entry {
+        uint32_t bucket;
+        int32_t cx, cy;
+        uint32_t body;
+    };
+
+    float cell_size = 0.f;   // 0 = derive from the bodies every update
+    float inv_size = 0.f;    // of the cells the last update used
+    List<AABB> boxes;
+    List<Entry> entries;
+    List<Entry> sorted;
+    List<uint32_t> bucket_end;
+    List<List<BodyPair>> chunk_pairs;       // pairs found by each chunk of buckets
+
+    static constexpr uint32_t ROW_GRAIN = 4096;
+    static constexpr uint32_t BUCKET_GRAIN = 2048;
+
+    static uint32_t hash(int32_t cx, int32_t cy) {
+        return static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u;
+    }
+
+    float autoCellSize(const BodyStore &store) const {
+        float extent = 0.f;
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            if (store.is_static[i])
+                continue;
+            Vec2 size = boxes[i].size();
+            extent += std::max(size.x, size.y);
+            count++;
+        }
+
+        // twice the mean extent: an average body touches at most 4 cells
+        return count > 0 && extent > 0.f ? 2.f * extent / static_cast<float>(count) : 64.f;
+    }
+
+ public:
+    UniformGrid() = default;
+    explicit UniformGrid(float cell_size): cell_size{cell_size} {}
+
+    void setCellSize(float size) {
+        cell_size = size;
+    }
+
+    [[nodiscard]] float cellSize() const {
+        return cell_size;
+    }
+
+    void update(const BodyStore &store, List<BodyPair> &pairs) override {
+        pairs.clear();
+        entries.clear();
+
+        boxes.resize(store.size());
+        parallelFor(store.size(), ROW_GRAIN, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+                boxes[i] = box(store, i);
+        });
+
+        const float size = cell_size > 0.f ? cell_size : autoCellSize(store);
+        inv_size = 1.f / size;
+
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            auto x0 = static_cast<int32_t>(std::floor(boxes[i].min.x * inv_size));
+            auto y0 = static_cast<int32_t>(std::floor(boxes[i].min.y * inv_size));
+            auto x1 = static_cast<int32_t>(std::floor(boxes[i].max.x * inv_size));
+            auto y1 = static_cast<int32_t>(std::floor(boxes[i].max.y * inv_size));
+
+            for (int32_t cy = y0; cy <= y1; ++cy)
+                for (int32_t cx = x0; cx <= x1; ++cx)
+                    entries.push_back({0, cx, cy, i});
+        }
+
+        // counting sort of the entries by hash bucket
+        uint32_t table_size = 16;
+        while (table_size < 2 * entries.size())
+            table_size <<= 1;
+        const uint32_t mask = table_size - 1;
+
+        bucket_end.assign(table_size, 0);
+        for (auto &entry : entries) {
+            entry.bucket = hash(entry.cx, entry.cy) & mask;
+            bucket_end[entry.bucket]++;
+        }
+        for (uint32_t b = 1; b < table_size; ++b)
+            bucket_end[b] += bucket_end[b - 1];
+
+        sorted.resize(entries.size());
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+            sorted[--bucket_end[it->bucket]] = *it;
+        // bucket_end[b] now holds the start of bucket b
+
+        // buckets are independent, each chunk of them collects its pairs on its own
+        // only ever grown, the table halving would otherwise free buffers the next substep needs again
+        const uint32_t chunk_count = (table_size + BUCKET_GRAIN - 1) / BUCKET_GRAIN;
+        if (chunk_pairs.size() < chunk_count)
+            chunk_pairs.resize(chunk_count);
+        parallelFor(table_size, BUCKET_GRAIN, [&](uint32_t first_bucket, uint32_t last_bucket) {
+            List<BodyPair> &found = chunk_pairs[first_bucket / BUCKET_GRAIN];
+            found.clear();
+
+            for (uint32_t b = first_bucket; b < last_bucket; ++b) {
+                const uint32_t begin = bucket_end[b];
+                const uint32_t end = b + 1 < table_size ? bucket_end[b + 1] : static_cast<uint32_t>(sorted.size());
+
+                for (uint32_t p = begin; p < end; ++p) {
+                    const Entry &e1 = sorted[p];
+
+                    for (uint32_t q = p + 1; q < end; ++q) {
+                        const Entry &e2 = sorted[q];
+
+                        // hash collision between different cells
+                        if (e1.cx != e2.cx || e1.cy != e2.cy)
+                            continue;
+
+                        const uint32_t i = e1.body, j = e2.body;
+                        if (store.is_static[i] && store.is_static[j])
+                            continue;
+                        if (!boxes[i].overlaps(boxes[j]))
+                            continue;
+
+                        // a pair sharing several cells is only reported by the cell that holds its overlap's min corner
+                        float min_x = std::max(boxes[i].min.x, boxes[j].min.x);
+                        float min_y = std::max(boxes[i].min.y, boxes[j].min.y);
+                        if (static_cast<int32_t>(std::floor(min_x * inv_size)) != e1.cx
+                            || static_cast<int32_t>(std::floor(min_y * inv_size)) != e1.cy)
+                            continue;
+
+                        found.emplace_back(std::min(i, j), std::max(i, j));
+                    }
+                }
+            }
+        });
+
+        for (uint32_t c = 0; c < chunk_count; ++c)
+            pairs.insert(pairs.end(), chunk_pairs[c].begin(), chunk_pairs[c].end());
+
+        // keep the all-pairs order so the result does not depend on the hash layout
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    void query(const AABB &box, List<uint32_t> &found) override {
+        const auto x0 = static_cast<int64_t>(std::floor(box.min.x * inv_size));
+        const auto y0 = static_cast<int64_t>(std::floor(box.min.y * inv_size));
+        const auto x1 = static_cast<int64_t>(std::floor(box.max.x * inv_size));
+        const auto y1 = static_cast<int64_t>(std::floor(box.max.y * inv_size));
+
+        // a box over more cells than there are entries is quicker to test against every body
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > static_cast<int64_t>(sorted.size())) {
+            for (uint32_t i = 0; i < boxes.size(); ++i) {
+                if (boxes[i].overlaps(box))
+                    found.push_back(i);
+            }
+            return;
+        }
+
+        const auto table_size = static_cast<uint32_t>(bucket_end.size());
+        const uint32_t mask = table_size - 1;
+        for (auto cy = static_cast<int32_t>(y0); cy <= y1; ++cy) {
+            for (auto cx = static_cast<int32_t>(x0); cx <= x1; ++cx) {
+                const uint32_t b = hash(cx, cy) & mask;
+                const uint32_t end = b + 1 < table_size ? bucket_end[b + 1] : static_cast<uint32_t>(sorted.size());
+                for (uint32_t p = bucket_end[b]; p < end; ++p) {
+                    const Entry &entry = sorted[p];
+                    if (entry.cx == cx && entry.cy == cy && boxes[entry.body].overlaps(box))
+                        found.push_back(entry.body);
+                }
+            }
+        }
+    }
+};
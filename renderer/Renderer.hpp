@@ -40,23 +40,28 @@ class Renderer {
         texts.emplace_back(f, position, character_size);
     }
 
-    void render(Solver solver) const {
+    void render(const Solver &solver) const {
         // Render constraints
-        for (int i = 0; i < solver.getConstraintCount(); ++i) {
-            for (auto drawable: solver.getConstraint(i)->render()) {
+        for (auto constraint : solver.getConstraintList()) {
+            for (auto drawable: constraint->render()) {
                 target.draw(*drawable);
             }
         }
 
         // Render objects
-        for (int i = 0; i < solver.getBodyCount(); ++i) {
-            for (auto drawable: solver.getBody(i)->render()) {
+        const sf::View &view = target.getView();
+        const AABB visible{view.getCenter() - view.getSize() / 2.f, view.getCenter() + view.getSize() / 2.f};
+        for (auto body : solver.getBodyList()) {
+            if (!body->aabb().overlaps(visible))
+                continue;
+
+            for (auto drawable: body->render()) {
                 target.draw(*drawable);
             }
         }
 
         float contact_radius = 5.f;
-        for (auto manifold: solver.getManifolds()) {
+        for (const auto &manifold: solver.getManifolds()) {
             if (manifold.contact_count == 0)
                 continue;
 
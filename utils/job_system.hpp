@@ -0,0 +1,185 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+// fixed pool of worker threads, each with its own work-stealing queue.
+// the thread calling parallelFor works too, so a pool of n threads starts n - 1 workers.
+class JobSystem {
+ private:
+    struct Job {
+        void (*run)(const void* context, uint32_t begin, uint32_t end);
+        const void* context;
+        uint32_t begin, end;
+        std::atomic<uint32_t>* remaining;
+    };
+
+    // the owner pops at the back, thieves take from the front
+    struct WorkQueue {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        size_t head = 0;
+
+        void push(const Job &job) {
+            std::lock_guard lock{mutex};
+            jobs.push_back(job);
+        }
+
+        bool pop(Job &job) {
+            std::lock_guard lock{mutex};
+            if (head == jobs.size())
+                return false;
+            job = jobs.back();
+            jobs.pop_back();
+            reset();
+            return true;
+        }
+
+        bool steal(Job &job) {
+            std::lock_guard lock{mutex};
+            if (head == jobs.size())
+                return false;
+            job = jobs[head++];
+            reset();
+            return true;
+        }
+
+        // keeps the capacity, so a warmed up queue never allocates
+        void reset() {
+            if (head == jobs.size()) {
+                jobs.clear();
+                head = 0;
+            }
+        }
+    };
+
+    uint32_t thread_count = 1;
+    std::vector<std::unique_ptr<WorkQueue>> queues;     // queues[0] belongs to the calling thread
+    std::vector<std::thread> workers;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<uint32_t> pending{0};                   // jobs pushed but not taken yet
+    bool stopping = false;
+
+    bool take(uint32_t self, Job &job) {
+        bool found = queues[self]->pop(job);
+        for (uint32_t k = 1; !found && k < queues.size(); ++k)
+            found = queues[(self + k) % queues.size()]->steal(job);
+
+        if (found)
+            pending.fetch_sub(1, std::memory_order_relaxed);
+        return found;
+    }
+
+    static void execute(const Job &job) {
+        job.run(job.context, job.begin, job.end);
+        job.remaining->fetch_sub(1, std::memory_order_release);
+    }
+
+    void workerLoop(uint32_t self) {
+        Job job{};
+        while (true) {
+            if (take(self, job)) {
+                execute(job);
+                continue;
+            }
+
+            std::unique_lock lock{sleep_mutex};
+            wake.wait(lock, [this] { return stopping || pending.load(std::memory_order_relaxed) > 0; });
+            if (stopping)
+                return;
+        }
+    }
+
+    void start() {
+        queues.clear();
+        for (uint32_t i = 0; i < thread_count; ++i)
+            queues.push_back(std::make_unique<WorkQueue>());
+
+        stopping = false;
+        for (uint32_t i = 1; i < thread_count; ++i)
+            workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+
+    void stop() {
+        {
+            std::lock_guard lock{sleep_mutex};
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto &worker : workers)
+            worker.join();
+        workers.clear();
+    }
+
+ public:
+    // 0 threads = one per hardware thread
+    explicit JobSystem(uint32_t threads = 0) {
+        setThreadCount(threads);
+    }
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+    ~JobSystem() {
+        stop();
+    }
+
+    // 1 runs every job on the calling thread in order, which makes a run reproducible step by step
+    void setThreadCount(uint32_t threads) {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        if (threads == thread_count && !queues.empty())
+            return;
+
+        stop();
+        thread_count = threads;
+        start();
+    }
+
+    [[nodiscard]] uint32_t threadCount() const {
+        return thread_count;
+    }
+
+    // calls fn(begin, end) for [0, grain), [grain, 2 * grain), ... up to count, then waits for all of them.
+    // the ranges only depend on count and grain, so chunk = begin / grain can index per-chunk output.
+    template <typename F>
+    void parallelFor(uint32_t count, uint32_t grain, const F &fn) {
+        grain = std::max(grain, 1u);
+        const uint32_t chunks = (count + grain - 1) / grain;
+
+        if (thread_count == 1 || chunks <= 1) {
+            for (uint32_t begin = 0; begin < count; begin += grain)
+                fn(begin, std::min(count, begin + grain));
+            return;
+        }
+
+        auto run = [](const void* context, uint32_t begin, uint32_t end) {
+            (*static_cast<const F*>(context))(begin, end);
+        };
+
+        std::atomic<uint32_t> remaining{chunks};
+        for (uint32_t c = 0; c < chunks; ++c) {
+            const uint32_t begin = c * grain;
+            queues[c % thread_count]->push({run, &fn, begin, std::min(count, begin + grain), &remaining});
+        }
+        {
+            std::lock_guard lock{sleep_mutex};
+            pending.fetch_add(chunks, std::memory_order_relaxed);
+        }
+        wake.notify_all();
+
+        Job job{};
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (take(0, job))
+                execute(job);
+            else
+                std::this_thread::yield();
+        }
+    }
+};
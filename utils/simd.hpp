@@ -0,0 +1,78 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PARTICLES_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PARTICLES_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// lets a single function use instructions the rest of the build was not compiled for.
+// msvc needs no flag for intrinsics, so it expands to nothing there.
+#if defined(PARTICLES_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PARTICLES_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PARTICLES_TARGET(isa)
+#endif
+
+enum SimdLevel {
+    SIMD_NONE,
+    SIMD_SSE,       // 4 lanes
+    SIMD_NEON,      // 4 lanes
+    SIMD_AVX2,      // 8 lanes
+};
+
+struct Simd {
+    // widest instruction set this cpu supports, detected once
+    static SimdLevel best() {
+        static const SimdLevel level = detect();
+        return level;
+    }
+
+    static bool supported(SimdLevel level) {
+        switch (level) {
+            case SIMD_NONE: return true;
+            case SIMD_NEON: return best() == SIMD_NEON;
+            default: return best() != SIMD_NEON && level <= best();
+        }
+    }
+
+    static const char* name(SimdLevel level) {
+        switch (level) {
+            case SIMD_SSE: return "sse";
+            case SIMD_NEON: return "neon";
+            case SIMD_AVX2: return "avx2";
+            default: return "scalar";
+        }
+    }
+
+ private:
+    static SimdLevel detect() {
+#if defined(PARTICLES_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SIMD_AVX2;
+        if (__builtin_cpu_supports("sse2"))
+            return SIMD_SSE;
+        return SIMD_NONE;
+#elif defined(PARTICLES_SIMD_X86)
+        int info[4];
+        __cpuid(info, 1);
+        const bool sse2 = info[3] & (1 << 26);
+        const bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        const bool avx2 = info[1] & (1 << 5);
+        if (avx2 && os_saves_ymm)
+            return SIMD_AVX2;
+        return sse2 ? SIMD_SSE : SIMD_NONE;
+#elif defined(PARTICLES_SIMD_NEON)
+        return SIMD_NEON;
+#else
+        return SIMD_NONE;
+#endif
+    }
+};